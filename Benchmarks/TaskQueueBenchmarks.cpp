@@ -0,0 +1,658 @@
+//
+//  TaskQueueBenchmarks.cpp
+//  Threads
+//
+//  Created by Gusts Kaksis on 16/10/2026.
+//  Copyright © 2026 Gusts Kaksis. All rights reserved.
+//
+
+#if defined(_WIN32)
+#   include <Windows.h>
+#endif
+
+#include "TaskQueueBenchmarks.hpp"
+#include "Threads/BasicTaskQueue.hpp"
+#include "Threads/TaskQueue.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+
+/// Node type used to compare raw ingress structures
+class IngressNode : public gusc::Threads::MpscQueueNode
+{};
+
+/// Reference ingress that replicates the original TaskQueue path: a recursive mutex around std::queue
+class MutexIngress
+{
+public:
+    inline void push(std::unique_ptr<IngressNode> node)
+    {
+        const std::lock_guard lock(mutex);
+        queue.emplace(std::move(node));
+    }
+    inline std::unique_ptr<IngressNode> pop()
+    {
+        const std::lock_guard lock(mutex);
+        if (queue.empty())
+        {
+            return nullptr;
+        }
+        auto next = std::move(queue.front());
+        queue.pop();
+        return next;
+    }
+private:
+    std::recursive_mutex mutex;
+    std::queue<std::unique_ptr<IngressNode>> queue;
+};
+
+/// Lock-free ingress used by TaskQueue
+class LockFreeIngress
+{
+public:
+    ~LockFreeIngress()
+    {
+        while (pop())
+        {}
+    }
+    inline void push(std::unique_ptr<IngressNode> node)
+    {
+        queue.push(node.release());
+    }
+    inline std::unique_ptr<IngressNode> pop()
+    {
+        return std::unique_ptr<IngressNode>(queue.pop());
+    }
+private:
+    gusc::Threads::IntrusiveMpscQueue<IngressNode> queue;
+};
+
+/// Push totalNodes nodes from producerCount threads while a single consumer drains them
+template<typename TIngress>
+double measureIngress(std::size_t producerCount, std::size_t totalNodes)
+{
+    TIngress ingress;
+    std::atomic_bool go { false };
+    const auto nodesPerProducer = totalNodes / producerCount;
+    const auto expected = nodesPerProducer * producerCount;
+
+    std::thread consumer([&](){
+        std::size_t received { 0 };
+        while (received != expected)
+        {
+            if (ingress.pop())
+            {
+                ++received;
+            }
+        }
+    });
+    std::vector<std::thread> producers;
+    for (std::size_t i = 0; i < producerCount; ++i)
+    {
+        producers.emplace_back([&](){
+            while (!go)
+            {
+                std::this_thread::yield();
+            }
+            for (std::size_t j = 0; j < nodesPerProducer; ++j)
+            {
+                ingress.push(std::make_unique<IngressNode>());
+            }
+        });
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    go = true;
+    for (auto& p : producers)
+    {
+        p.join();
+    }
+    consumer.join();
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(expected) / elapsed / 1'000'000.0;
+}
+
+/// Post totalTasks tiny tasks from producerCount threads and measure how long it takes until all of them have run
+template<typename TQueue>
+double measureThroughput(TQueue& queue, std::size_t producerCount, std::size_t totalTasks)
+{
+    std::atomic<std::size_t> executed { 0 };
+    std::atomic_bool go { false };
+    const auto tasksPerProducer = totalTasks / producerCount;
+    const auto expected = tasksPerProducer * producerCount;
+
+    std::vector<std::thread> producers;
+    for (std::size_t i = 0; i < producerCount; ++i)
+    {
+        producers.emplace_back([&](){
+            while (!go)
+            {
+                std::this_thread::yield();
+            }
+            for (std::size_t j = 0; j < tasksPerProducer; ++j)
+            {
+                queue.send([&executed](){
+                    executed.fetch_add(1, std::memory_order_relaxed);
+                });
+            }
+        });
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    go = true;
+    for (auto& p : producers)
+    {
+        p.join();
+    }
+    while (executed.load(std::memory_order_relaxed) != expected)
+    {
+        std::this_thread::yield();
+    }
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(expected) / elapsed / 1'000'000.0;
+}
+
+const std::size_t producerCounts[] { 1, 2, 4, 8, 16, 32 };
+
+/// This benchmark compares producer scaling of the original mutex ingress against the lock-free TaskQueue ingress
+void ingressContentionBenchmark()
+{
+    constexpr std::size_t totalNodes { 2'000'000 };
+
+    std::cout << "Ingress contention, single consumer (" << totalNodes << " nodes, Mnodes/s)" << std::endl;
+    std::cout << std::setw(10) << "producers" << std::setw(16) << "mutex" << std::setw(16) << "lock-free" << std::endl;
+    for (const auto producerCount : producerCounts)
+    {
+        const auto mutexResult = measureIngress<MutexIngress>(producerCount, totalNodes);
+        const auto lockFreeResult = measureIngress<LockFreeIngress>(producerCount, totalNodes);
+        std::cout << std::setw(10) << producerCount
+                  << std::setw(16) << std::fixed << std::setprecision(2) << mutexResult
+                  << std::setw(16) << std::fixed << std::setprecision(2) << lockFreeResult << std::endl;
+    }
+}
+
+/// This benchmark measures end-to-end throughput of SerialTaskQueue with many producers
+void serialTaskQueueThroughputBenchmark()
+{
+    constexpr std::size_t totalTasks { 1'000'000 };
+
+    std::cout << "SerialTaskQueue throughput (" << totalTasks << " tasks, Mtasks/s)" << std::endl;
+    std::cout << std::setw(10) << "producers" << std::setw(16) << "send" << std::endl;
+    for (const auto producerCount : producerCounts)
+    {
+        gusc::Threads::SerialTaskQueue queue;
+        const auto result = measureThroughput(queue, producerCount, totalTasks);
+        std::cout << std::setw(10) << producerCount
+                  << std::setw(16) << std::fixed << std::setprecision(2) << result << std::endl;
+    }
+}
+
+
+/// Measure the average cost of sending and executing a task with a capture of TCaptureSize bytes
+template<std::size_t TCaptureSize>
+double measureSendCost(gusc::Threads::SerialTaskQueue& queue, std::size_t totalTasks)
+{
+    std::array<char, TCaptureSize> capture {};
+    std::atomic<std::size_t> executed { 0 };
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < totalTasks; ++i)
+    {
+        queue.send([&executed, capture](){
+            executed.fetch_add(static_cast<std::size_t>(capture[0]) + 1, std::memory_order_relaxed);
+        });
+    }
+    while (executed.load(std::memory_order_relaxed) != totalTasks)
+    {
+        std::this_thread::yield();
+    }
+    const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return elapsed / static_cast<double>(totalTasks);
+}
+
+/// This benchmark measures the per-task cost of small (inline) and large (heap) captures
+void sendCostBenchmark()
+{
+    constexpr std::size_t totalTasks { 1'000'000 };
+
+    std::cout << "SerialTaskQueue send cost by capture size (" << totalTasks << " tasks, ns/task)" << std::endl;
+    std::cout << std::setw(10) << "capture" << std::setw(16) << "ns/task" << std::setw(20) << "system allocs" << std::endl;
+    gusc::Threads::SerialTaskQueue queue;
+    auto slab = gusc::Threads::SlabMemoryResource::getDefault();
+    const auto measure = [&](std::size_t size, auto measureFunction){
+        // First run warms up the allocator caches, the second one should not need any system allocations
+        measureFunction(queue, totalTasks);
+        const auto before = slab->getStatistics().systemAllocationCount;
+        const auto result = measureFunction(queue, totalTasks);
+        const auto allocations = slab->getStatistics().systemAllocationCount - before;
+        std::cout << std::setw(10) << size
+                  << std::setw(16) << std::fixed << std::setprecision(1) << result
+                  << std::setw(20) << allocations << std::endl;
+    };
+    measure(8, measureSendCost<8>);
+    measure(32, measureSendCost<32>);
+    measure(128, measureSendCost<128>);
+    measure(512, measureSendCost<512>);
+}
+
+
+/// Measure producer-side cost of submitting totalTasks tasks in bursts of burstSize, either one by one or as a batch
+double measureSubmission(gusc::Threads::SerialTaskQueue& queue, std::size_t totalTasks, std::size_t burstSize, bool isBatch)
+{
+    std::atomic<std::size_t> executed { 0 };
+    auto task = [&executed](){
+        executed.fetch_add(1, std::memory_order_relaxed);
+    };
+    const std::vector<decltype(task)> burst(burstSize, task);
+    double elapsed { 0.0 };
+    for (std::size_t sent = 0; sent < totalTasks; sent += burstSize)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        if (isBatch)
+        {
+            queue.sendBatch(burst.begin(), burst.end());
+        }
+        else
+        {
+            for (const auto& t : burst)
+            {
+                queue.send(t);
+            }
+        }
+        elapsed += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        // Let the queue drain so that every burst hits an idle consumer
+        while (executed.load(std::memory_order_relaxed) != sent + burstSize)
+        {
+            std::this_thread::yield();
+        }
+    }
+    return elapsed / static_cast<double>(totalTasks);
+}
+
+/// This benchmark compares producer-side submission cost of bursts sent one by one against sendBatch()
+void batchSubmissionBenchmark()
+{
+    constexpr std::size_t totalTasks { 512'000 };
+    const std::size_t burstSizes[] { 16, 256, 4096 };
+
+    std::cout << "SerialTaskQueue burst submission cost (" << totalTasks << " tasks, ns/task on producer)" << std::endl;
+    std::cout << std::setw(10) << "burst" << std::setw(16) << "send" << std::setw(16) << "sendBatch" << std::endl;
+    gusc::Threads::SerialTaskQueue queue;
+    for (const auto burstSize : burstSizes)
+    {
+        // Warm up the allocator caches
+        measureSubmission(queue, totalTasks, burstSize, true);
+        const auto sendResult = measureSubmission(queue, totalTasks, burstSize, false);
+        const auto batchResult = measureSubmission(queue, totalTasks, burstSize, true);
+        std::cout << std::setw(10) << burstSize
+                  << std::setw(16) << std::fixed << std::setprecision(1) << sendResult
+                  << std::setw(16) << std::fixed << std::setprecision(1) << batchResult << std::endl;
+    }
+}
+
+
+/// This benchmark measures the cost of a task posting a follow-up task to it's own queue (a typical state machine pattern)
+void selfSendBenchmark()
+{
+    constexpr std::size_t totalTasks { 1'000'000 };
+
+    std::cout << "SerialTaskQueue self-send cost (" << totalTasks << " tasks, ns/task)" << std::endl;
+    gusc::Threads::SerialTaskQueue queue;
+    std::promise<void> promise;
+    auto future = promise.get_future();
+    std::size_t remaining { totalTasks };
+    std::function<void()> step = [&](){
+        if (--remaining == 0)
+        {
+            promise.set_value();
+        }
+        else
+        {
+            queue.send([&](){
+                step();
+            });
+        }
+    };
+    const auto start = std::chrono::steady_clock::now();
+    queue.send([&](){
+        step();
+    });
+    future.wait();
+    const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::setw(10) << "self" << std::setw(16) << std::fixed << std::setprecision(1) << elapsed / static_cast<double>(totalTasks) << std::endl;
+}
+
+/// Measure latency from send() to the start of execution when the queue thread has been idle for the given gap
+std::vector<double> measureWakeLatency(gusc::Threads::SerialTaskQueue& queue, std::chrono::nanoseconds gap, std::size_t count)
+{
+    std::vector<double> latencies;
+    latencies.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        // Busy-wait as sleep_for is too coarse for short gaps
+        const auto gapEnd = std::chrono::steady_clock::now() + gap;
+        while (std::chrono::steady_clock::now() < gapEnd)
+        {}
+        std::atomic_bool isExecuted { false };
+        std::chrono::steady_clock::time_point executedAt;
+        const auto sentAt = std::chrono::steady_clock::now();
+        queue.send([&](){
+            executedAt = std::chrono::steady_clock::now();
+            isExecuted = true;
+        });
+        while (!isExecuted)
+        {
+            std::this_thread::yield();
+        }
+        latencies.emplace_back(std::chrono::duration<double, std::micro>(executedAt - sentAt).count());
+    }
+    std::sort(latencies.begin(), latencies.end());
+    return latencies;
+}
+
+/// This benchmark compares send-to-execution latency of idle policies at different gaps between tasks
+void idlePolicyLatencyBenchmark()
+{
+    constexpr std::size_t count { 2'000 };
+    const std::chrono::microseconds gaps[] { 5us, 20us, 100us, 1000us };
+    const std::pair<const char*, gusc::Threads::IdlePolicy> policies[] {
+        { "blocking", gusc::Threads::IdlePolicy::Blocking },
+        { "spin", gusc::Threads::IdlePolicy::Spin },
+        { "adaptive", gusc::Threads::IdlePolicy::Adaptive }
+    };
+
+    std::cout << "SerialTaskQueue wake-up latency by idle policy (" << count << " tasks, us p50/p99)" << std::endl;
+    std::cout << std::setw(10) << "gap";
+    for (const auto& policy : policies)
+    {
+        std::cout << std::setw(20) << policy.first;
+    }
+    std::cout << std::endl;
+    for (const auto gap : gaps)
+    {
+        std::cout << std::setw(8) << gap.count() << "us";
+        for (const auto& policy : policies)
+        {
+            gusc::Threads::TaskQueueOptions options;
+            options.idlePolicy = policy.second;
+            gusc::Threads::SerialTaskQueue queue { "Benchmark", options };
+            const auto latencies = measureWakeLatency(queue, gap, count);
+            std::ostringstream result;
+            result << std::fixed << std::setprecision(1) << latencies[latencies.size() / 2] << "/" << latencies[latencies.size() * 99 / 100];
+            std::cout << std::setw(20) << result.str();
+        }
+        std::cout << std::endl;
+    }
+}
+
+/// Result of measurePolicyCost
+struct PolicyCost
+{
+    double send;
+    double execute;
+};
+
+/// Measure the average cost of sending a tiny task from a single producer thread and executing it on the queue thread
+/// @note the queue thread is held by a blocking task while the producer is sending, so that both sides are measured without the wake-up cost
+template<typename TQueue>
+PolicyCost measurePolicyCost(std::size_t totalTasks)
+{
+    TQueue queue;
+    std::atomic<std::size_t> executed { 0 };
+    const auto run = [&](){
+        executed = 0;
+        std::promise<void> release;
+        auto released = release.get_future().share();
+        std::promise<void> blocked;
+        queue.send([released, &blocked](){
+            blocked.set_value();
+            released.wait();
+        });
+        blocked.get_future().wait();
+        const auto sendStart = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < totalTasks; ++i)
+        {
+            queue.send([&executed](){
+                executed.fetch_add(1, std::memory_order_relaxed);
+            });
+        }
+        const auto executeStart = std::chrono::steady_clock::now();
+        release.set_value();
+        while (executed.load(std::memory_order_relaxed) != totalTasks)
+        {
+            std::this_thread::yield();
+        }
+        const auto executeEnd = std::chrono::steady_clock::now();
+        return PolicyCost {
+            std::chrono::duration<double, std::nano>(executeStart - sendStart).count() / static_cast<double>(totalTasks),
+            std::chrono::duration<double, std::nano>(executeEnd - executeStart).count() / static_cast<double>(totalTasks)
+        };
+    };
+    // First run warms up the allocator caches
+    run();
+    return run();
+}
+
+/// This benchmark compares per-task cost of the full SerialTaskQueue against lean BasicTaskQueue configurations
+void policyConfigurationBenchmark()
+{
+    using namespace gusc::Threads;
+    constexpr std::size_t totalTasks { 1'000'000 };
+
+    std::cout << "BasicTaskQueue cost by policy (" << totalTasks << " tasks, single producer, ns/task)" << std::endl;
+    std::cout << std::setw(48) << "configuration" << std::setw(16) << "send" << std::setw(16) << "execute" << std::endl;
+    const auto print = [](const char* name, PolicyCost result){
+        std::cout << std::setw(48) << name
+                  << std::setw(16) << std::fixed << std::setprecision(1) << result.send
+                  << std::setw(16) << std::fixed << std::setprecision(1) << result.execute << std::endl;
+    };
+    print("SerialTaskQueue (MultiProducer, Delayed, Sub)", measurePolicyCost<BasicTaskQueue<>>(totalTasks));
+    print("MultiProducer, WithDelayedTasks", measurePolicyCost<BasicTaskQueue<MultiProducer, WithDelayedTasks, WithoutSubQueues>>(totalTasks));
+    print("MultiProducer, WithoutDelayedTasks", measurePolicyCost<BasicTaskQueue<MultiProducer, WithoutDelayedTasks, WithoutSubQueues>>(totalTasks));
+    print("SingleProducer, WithDelayedTasks", measurePolicyCost<BasicTaskQueue<SingleProducer, WithDelayedTasks, WithoutSubQueues>>(totalTasks));
+    print("SingleProducer, WithoutDelayedTasks", measurePolicyCost<BasicTaskQueue<SingleProducer, WithoutDelayedTasks, WithoutSubQueues>>(totalTasks));
+}
+
+/// This benchmark measures per-task cost of a single busy sub-queue as the number of idle sub-queues grows
+void subQueueScalingBenchmark()
+{
+    constexpr std::size_t totalTasks { 200'000 };
+    const std::size_t subQueueCounts[] { 1, 100, 2'000, 10'000 };
+
+    std::cout << "Sub-queue scaling, one busy sub-queue (" << totalTasks << " tasks, ns/task)" << std::endl;
+    std::cout << std::setw(10) << "sub-queues" << std::setw(16) << "ns/task" << std::endl;
+    for (const auto subQueueCount : subQueueCounts)
+    {
+        gusc::Threads::SerialTaskQueue queue;
+        std::vector<std::shared_ptr<gusc::Threads::TaskQueue>> subQueues;
+        for (std::size_t i = 0; i < subQueueCount; ++i)
+        {
+            subQueues.push_back(queue.createSubQueue());
+        }
+        // The busy sub-queue is the last one created
+        auto& busyQueue = *subQueues.back();
+        std::atomic<std::size_t> executed { 0 };
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < totalTasks; ++i)
+        {
+            busyQueue.send([&executed](){
+                executed.fetch_add(1, std::memory_order_relaxed);
+            });
+        }
+        while (executed.load(std::memory_order_relaxed) != totalTasks)
+        {
+            std::this_thread::yield();
+        }
+        const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        std::cout << std::setw(10) << subQueueCount
+                  << std::setw(16) << std::fixed << std::setprecision(1) << elapsed / static_cast<double>(totalTasks) << std::endl;
+    }
+}
+
+/// This benchmark shows per-tenant wait times when one sub-queue floods the queue while the others send a few tasks each
+void subQueueFairnessBenchmark()
+{
+    constexpr std::size_t chattyTasks { 20'000 };
+    constexpr std::size_t lightTasks { 200 };
+    constexpr std::size_t lightTenants { 9 };
+    const auto taskDuration = 5us;
+
+    std::cout << "Sub-queue wait times under skewed load (tenant 0 sends " << chattyTasks << " tasks, others " << lightTasks << " each, "
+              << taskDuration.count() << "us tasks)" << std::endl;
+    std::cout << std::setw(10) << "tenant" << std::setw(10) << "tasks" << std::setw(16) << "avg wait ms" << std::setw(16) << "max wait ms" << std::endl;
+    gusc::Threads::SerialTaskQueue queue;
+    std::vector<std::shared_ptr<gusc::Threads::TaskQueue>> tenants;
+    for (std::size_t i = 0; i < lightTenants + 1; ++i)
+    {
+        tenants.push_back(queue.createSubQueue());
+    }
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    queue.send([released](){
+        released.wait();
+    });
+    std::atomic<std::size_t> executed { 0 };
+    const auto task = [&executed, taskDuration](){
+        const auto end = std::chrono::steady_clock::now() + taskDuration;
+        while (std::chrono::steady_clock::now() < end)
+        {}
+        executed.fetch_add(1, std::memory_order_relaxed);
+    };
+    // The chatty tenant was created first and sends all of it's tasks first
+    for (std::size_t i = 0; i < chattyTasks; ++i)
+    {
+        tenants[0]->send(task);
+    }
+    for (std::size_t i = 0; i < lightTasks; ++i)
+    {
+        for (std::size_t t = 1; t < tenants.size(); ++t)
+        {
+            tenants[t]->send(task);
+        }
+    }
+    release.set_value();
+    const auto expected = chattyTasks + lightTasks * lightTenants;
+    while (executed.load(std::memory_order_relaxed) != expected)
+    {
+        std::this_thread::sleep_for(1ms);
+    }
+    for (std::size_t t = 0; t < tenants.size(); ++t)
+    {
+        const auto statistics = tenants[t]->getStatistics();
+        const auto averageWait = std::chrono::duration<double, std::milli>(statistics.totalWaitTime).count() / static_cast<double>(std::max<std::size_t>(statistics.executedCount, 1));
+        std::cout << std::setw(10) << t << std::setw(10) << statistics.executedCount
+                  << std::setw(16) << std::fixed << std::setprecision(2) << averageWait
+                  << std::setw(16) << std::fixed << std::setprecision(2) << std::chrono::duration<double, std::milli>(statistics.maxWaitTime).count() << std::endl;
+    }
+}
+
+
+/// Measure producer-side cost of sendDelayed() while totalTimers timeouts are pending
+double measureDelayedSendCost(gusc::Threads::TimerBackend backend, std::size_t totalTimers)
+{
+    gusc::Threads::TaskQueueOptions options;
+    options.timerBackend = backend;
+    gusc::Threads::SerialTaskQueue queue { "DelayedQueue", options };
+    std::mt19937 random { 1 };
+    // Timeouts of in-flight requests, none of them expire during the measurement
+    std::uniform_int_distribution<int> timeouts { 10'000, 60'000 };
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < totalTimers; ++i)
+    {
+        queue.sendDelayed([](){}, std::chrono::milliseconds(timeouts(random)));
+    }
+    const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    queue.cancelAll();
+    return elapsed / static_cast<double>(totalTimers);
+}
+
+/// This benchmark compares the cost of keeping many pending timeouts in the ordered set and in the timing wheel
+void timerBackendBenchmark()
+{
+    const std::size_t timerCounts[] { 1'000, 50'000, 500'000 };
+
+    std::cout << "SerialTaskQueue sendDelayed cost by timer backend (ns/timer on producer)" << std::endl;
+    std::cout << std::setw(10) << "pending" << std::setw(16) << "OrderedSet" << std::setw(16) << "TimingWheel" << std::endl;
+    for (const auto count : timerCounts)
+    {
+        const auto orderedSet = measureDelayedSendCost(gusc::Threads::TimerBackend::OrderedSet, count);
+        const auto timingWheel = measureDelayedSendCost(gusc::Threads::TimerBackend::TimingWheel, count);
+        std::cout << std::setw(10) << count
+                  << std::setw(16) << std::fixed << std::setprecision(1) << orderedSet
+                  << std::setw(16) << std::fixed << std::setprecision(1) << timingWheel << std::endl;
+    }
+}
+
+
+/// Measure how late delayed tasks start after their delay has elapsed (in microseconds, sorted)
+std::vector<double> measureDelayedLateness(gusc::Threads::TimerPrecision precision, std::chrono::microseconds delay, std::size_t count)
+{
+    gusc::Threads::TaskQueueOptions options;
+    options.timerPrecision = precision;
+    gusc::Threads::SerialTaskQueue queue { "DelayedQueue", options };
+    std::vector<double> latenesses;
+    latenesses.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        std::promise<std::chrono::steady_clock::time_point> promise;
+        auto future = promise.get_future();
+        const auto dueTime = std::chrono::steady_clock::now() + delay;
+        queue.sendDelayed([&promise](){
+            promise.set_value(std::chrono::steady_clock::now());
+        }, std::chrono::duration_cast<std::chrono::milliseconds>(delay));
+        latenesses.emplace_back(std::chrono::duration<double, std::micro>(future.get() - dueTime).count());
+    }
+    std::sort(latenesses.begin(), latenesses.end());
+    return latenesses;
+}
+
+/// This benchmark compares the lateness of sendDelayed() when the queue thread sleeps on the condition variable and on the precise timer
+void timerPrecisionBenchmark()
+{
+    constexpr std::size_t count { 500 };
+    const std::pair<const char*, gusc::Threads::TimerPrecision> precisions[] {
+        { "Default", gusc::Threads::TimerPrecision::Default },
+        { "High", gusc::Threads::TimerPrecision::High }
+    };
+
+    std::cout << "SerialTaskQueue sendDelayed lateness by timer precision (1 ms delay, " << count << " tasks, us)" << std::endl;
+    std::cout << std::setw(10) << "precision" << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99" << std::setw(10) << "max" << std::endl;
+    for (const auto& precision : precisions)
+    {
+        const auto latenesses = measureDelayedLateness(precision.second, 1000us, count);
+        std::cout << std::setw(10) << precision.first << std::fixed << std::setprecision(1)
+                  << std::setw(10) << latenesses[latenesses.size() / 2]
+                  << std::setw(10) << latenesses[latenesses.size() * 9 / 10]
+                  << std::setw(10) << latenesses[latenesses.size() * 99 / 100]
+                  << std::setw(10) << latenesses.back() << std::endl;
+    }
+}
+
+}
+
+void runTaskQueueBenchmarks()
+{
+    ingressContentionBenchmark();
+    serialTaskQueueThroughputBenchmark();
+    sendCostBenchmark();
+    batchSubmissionBenchmark();
+    selfSendBenchmark();
+    idlePolicyLatencyBenchmark();
+    policyConfigurationBenchmark();
+    subQueueScalingBenchmark();
+    subQueueFairnessBenchmark();
+    timerBackendBenchmark();
+    timerPrecisionBenchmark();
+}
@@ -0,0 +1,14 @@
+//
+//  TaskQueueBenchmarks.hpp
+//  Threads
+//
+//  Created by Gusts Kaksis on 16/10/2026.
+//  Copyright © 2026 Gusts Kaksis. All rights reserved.
+//
+
+#ifndef TaskQueueBenchmarks_hpp
+#define TaskQueueBenchmarks_hpp
+
+void runTaskQueueBenchmarks();
+
+#endif /* TaskQueueBenchmarks_hpp */
@@ -0,0 +1,14 @@
+//
+//  main.cpp
+//  Threads
+//
+//  Created by Gusts Kaksis on 16/10/2026.
+//  Copyright © 2026 Gusts Kaksis. All rights reserved.
+//
+
+#include "TaskQueueBenchmarks.hpp"
+
+int main(int argc, const char * argv[]) {
+    runTaskQueueBenchmarks();
+    return 0;
+}
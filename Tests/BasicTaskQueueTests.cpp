@@ -0,0 +1,93 @@
+//
+//  BasicTaskQueueTests.cpp
+//  Threads
+//
+//  Created by Gusts Kaksis on 16/10/2026.
+//  Copyright © 2026 Gusts Kaksis. All rights reserved.
+//
+
+#include <gtest/gtest.h>
+
+#include "Threads/BasicTaskQueue.hpp"
+
+#include <chrono>
+#include <type_traits>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+static_assert(std::is_same_v<gusc::Threads::BasicTaskQueue<>, gusc::Threads::SerialTaskQueue>);
+static_assert(std::is_same_v<gusc::Threads::BasicTaskQueue<gusc::Threads::SingleProducer, gusc::Threads::WithoutDelayedTasks, gusc::Threads::WithSubQueues>, gusc::Threads::SerialTaskQueue>);
+static_assert(std::is_same_v<gusc::Threads::BasicTaskQueue<gusc::Threads::SingleProducer, gusc::Threads::WithoutDelayedTasks, gusc::Threads::WithoutSubQueues>,
+                             gusc::Threads::LeanTaskQueue<gusc::Threads::SingleProducer, gusc::Threads::WithoutDelayedTasks>>);
+
+template<typename TQueue>
+class LeanTaskQueueTest : public ::testing::Test
+{
+public:
+    TQueue queue { "LeanQueue" };
+};
+
+using LeanTaskQueueTypes = ::testing::Types<
+    gusc::Threads::BasicTaskQueue<gusc::Threads::MultiProducer, gusc::Threads::WithDelayedTasks, gusc::Threads::WithoutSubQueues>,
+    gusc::Threads::BasicTaskQueue<gusc::Threads::MultiProducer, gusc::Threads::WithoutDelayedTasks, gusc::Threads::WithoutSubQueues>,
+    gusc::Threads::BasicTaskQueue<gusc::Threads::SingleProducer, gusc::Threads::WithDelayedTasks, gusc::Threads::WithoutSubQueues>,
+    gusc::Threads::BasicTaskQueue<gusc::Threads::SingleProducer, gusc::Threads::WithoutDelayedTasks, gusc::Threads::WithoutSubQueues>
+>;
+TYPED_TEST_SUITE(LeanTaskQueueTest, LeanTaskQueueTypes);
+
+TYPED_TEST(LeanTaskQueueTest, SendOrder)
+{
+    // More tasks than fit in a single ring segment or a single batch
+    constexpr int numTasks { 1000 };
+    std::vector<int> order;
+    for (int i = 0; i < numTasks; ++i)
+    {
+        this->queue.send([&order, i](){
+            order.push_back(i);
+        });
+    }
+    this->queue.sendWait([](){});
+    ASSERT_EQ(order.size(), static_cast<std::size_t>(numTasks));
+    for (int i = 0; i < numTasks; ++i)
+    {
+        EXPECT_EQ(order[i], i);
+    }
+}
+
+TYPED_TEST(LeanTaskQueueTest, SendSync)
+{
+    EXPECT_FALSE(this->queue.getIsSameThread());
+    EXPECT_EQ(this->queue.template sendSync<int>([](){ return 42; }), 42);
+    EXPECT_THROW(this->queue.template sendSync<int>([]() -> int { throw std::runtime_error("Task failed"); }), std::runtime_error);
+    // Synchronous task sent from the queue thread itself must not deadlock
+    EXPECT_EQ(this->queue.template sendSync<int>([this](){
+        return this->queue.template sendSync<int>([this](){
+            return this->queue.getIsSameThread() ? 1 : 0;
+        });
+    }), 1);
+}
+
+TEST(LeanTaskQueueDelayedTest, SendDelayed)
+{
+    gusc::Threads::LeanTaskQueue<gusc::Threads::SingleProducer, gusc::Threads::WithDelayedTasks> queue { "LeanQueue" };
+    std::vector<int> order;
+    std::promise<void> promise;
+    auto future = promise.get_future();
+    const auto timeStart = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point timeEnd;
+    queue.sendDelayed([&](){
+        order.push_back(2);
+        timeEnd = std::chrono::steady_clock::now();
+        promise.set_value();
+    }, 20ms);
+    queue.sendDelayed([&](){
+        order.push_back(1);
+    }, 10ms);
+    queue.send([&](){
+        order.push_back(0);
+    });
+    ASSERT_EQ(future.wait_for(1s), std::future_status::ready);
+    EXPECT_EQ(order, std::vector<int>({ 0, 1, 2 }));
+    EXPECT_GE(timeEnd - timeStart, 20ms);
+}
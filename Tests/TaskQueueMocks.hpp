@@ -12,6 +12,9 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <memory_resource>
+
 using namespace ::testing;
 
 class TaskQueueMock
@@ -22,6 +25,30 @@ public:
     MOCK_METHOD(void, recover, ());
 };
 
+/// Memory resource that counts allocations passed to the new/delete resource
+class CountingMemoryResource : public std::pmr::memory_resource
+{
+public:
+    std::atomic<std::size_t> allocationCount { 0 };
+    std::atomic<std::size_t> deallocationCount { 0 };
+
+protected:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        ++allocationCount;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override
+    {
+        ++deallocationCount;
+        std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
 namespace {
 
 class TaskQueueMockWrapper
@@ -8,6 +8,8 @@
 
 #if defined(_WIN32)
 #   include <Windows.h>
+#elif defined(__linux__)
+#   include <sys/prctl.h>
 #endif
 
 #include <gtest/gtest.h>
@@ -16,6 +18,8 @@
 #include "Threads/TaskQueue.hpp"
 #include "TaskQueueMocks.hpp"
 
+#include <algorithm>
+#include <array>
 #include <chrono>
 
 using namespace std::chrono_literals;
@@ -100,6 +104,251 @@ TEST_F(SerialTaskQueueTest, Send)
     mock.setMock(nullptr);
 }
 
+TEST_F(SerialTaskQueueTest, SendFromMultipleThreads)
+{
+    constexpr int numProducers { 8 };
+    constexpr int numTasks { 10000 };
+
+    std::vector<int> lastSeen(numProducers, -1);
+    std::atomic_int executed { 0 };
+    std::atomic_bool inOrder { true };
+    std::vector<std::thread> producers;
+    for (int p = 0; p < numProducers; ++p)
+    {
+        producers.emplace_back([&, p](){
+            for (int i = 0; i < numTasks; ++i)
+            {
+                queue.send([&, p, i](){
+                    // Tasks from a single producer must arrive in FIFO order
+                    if (lastSeen[p] + 1 != i)
+                    {
+                        inOrder = false;
+                    }
+                    lastSeen[p] = i;
+                    ++executed;
+                });
+            }
+        });
+    }
+    for (auto& t : producers)
+    {
+        t.join();
+    }
+    queue.sendWait([](){});
+
+    EXPECT_TRUE(inOrder);
+    EXPECT_EQ(executed, numProducers * numTasks);
+}
+
+TEST_F(SerialTaskQueueTest, WakeUpFromIdle)
+{
+    // Every task arrives while the queue thread is (about to go) idle, none of the wake-ups may be lost
+    for (int i = 0; i < 1000; ++i)
+    {
+        std::promise<void> promise;
+        auto future = promise.get_future();
+        std::thread producer([&](){
+            queue.send([&](){
+                promise.set_value();
+            });
+        });
+        ASSERT_EQ(future.wait_for(1s), std::future_status::ready);
+        producer.join();
+    }
+}
+
+TEST(TaskQueueLifetimeTest, DestroyIdleSerialQueue)
+{
+    for (int i = 0; i < 100; ++i)
+    {
+        gusc::Threads::SerialTaskQueue serialQueue;
+    }
+}
+
+TEST(TaskQueueIdlePolicyTest, WakeUp)
+{
+    for (const auto policy : { gusc::Threads::IdlePolicy::Blocking, gusc::Threads::IdlePolicy::Spin, gusc::Threads::IdlePolicy::Adaptive })
+    {
+        gusc::Threads::TaskQueueOptions options;
+        options.idlePolicy = policy;
+        options.maxSpinDuration = 200us;
+        gusc::Threads::SerialTaskQueue serialQueue { "SerialQueue", options };
+        for (int i = 0; i < 200; ++i)
+        {
+            // Alternate between gaps shorter and longer than the spin duration
+            std::this_thread::sleep_for(i % 2 ? 10us : 500us);
+            EXPECT_EQ(serialQueue.sendSync<int>([i](){ return i; }), i);
+        }
+        std::promise<void> delayedPromise;
+        auto delayedFuture = delayedPromise.get_future();
+        serialQueue.sendDelayed([&](){
+            delayedPromise.set_value();
+        }, 1ms);
+        EXPECT_EQ(delayedFuture.wait_for(1s), std::future_status::ready);
+    }
+}
+
+TEST_F(SerialTaskQueueTest, SendFromSameThread)
+{
+    constexpr int numTasks { 10000 };
+
+    // A chain of tasks that keep posting follow-ups to their own queue, while another thread posts to it too
+    std::vector<int> order;
+    std::atomic_int executedExternal { 0 };
+    std::function<void(int)> postNext = [&](int i){
+        order.emplace_back(i);
+        if (i + 1 < numTasks)
+        {
+            queue.send([&, i](){
+                postNext(i + 1);
+            });
+        }
+    };
+    queue.send([&](){
+        postNext(0);
+    });
+    std::thread producer([&](){
+        for (int i = 0; i < numTasks; ++i)
+        {
+            queue.send([&](){
+                ++executedExternal;
+            });
+        }
+    });
+    producer.join();
+    while (queue.sendSync<std::size_t>([&](){ return order.size(); }) != numTasks)
+    {
+        std::this_thread::yield();
+    }
+
+    EXPECT_EQ(executedExternal, numTasks);
+    for (int i = 0; i < numTasks; ++i)
+    {
+        ASSERT_EQ(order[i], i);
+    }
+}
+
+TEST_F(SerialTaskQueueTest, SendFromSameThreadAfterCancelAll)
+{
+    std::promise<void> promise;
+    auto future = promise.get_future();
+    std::atomic_bool isCancelledTaskExecuted { false };
+    std::vector<std::function<void()>> tasks {
+        [&](){
+            queue.cancelAll();
+            queue.send([&](){
+                promise.set_value();
+            });
+        },
+        [&](){
+            isCancelledTaskExecuted = true;
+        }
+    };
+    queue.sendBatch(tasks.begin(), tasks.end());
+
+    EXPECT_EQ(future.wait_for(1s), std::future_status::ready);
+    EXPECT_FALSE(isCancelledTaskExecuted);
+}
+
+TEST_F(SerialTaskQueueTest, SendCaptures)
+{
+    auto small = std::make_shared<int>(1);
+    auto large = std::make_shared<std::array<char, 256>>();
+    large->fill('a');
+
+    std::array<char, 256> largeCopy;
+    largeCopy.fill('b');
+    int result { 0 };
+    // Small captures are stored inline in the task node
+    queue.send([small, &result](){
+        result += *small;
+    });
+    // Large captures fall back to the heap
+    queue.send([large, largeCopy, &result](){
+        result += (largeCopy[255] == 'b' && (*large)[0] == 'a') ? 10 : 0;
+    });
+    queue.sendWait([](){});
+
+    EXPECT_EQ(result, 11);
+    // Captured objects must be destroyed once tasks have executed
+    EXPECT_EQ(small.use_count(), 1);
+    EXPECT_EQ(large.use_count(), 1);
+}
+
+TEST_F(SerialTaskQueueTest, SendBatch)
+{
+    std::vector<int> order;
+    std::vector<std::function<void()>> tasks;
+    for (int i = 0; i < 100; ++i)
+    {
+        tasks.emplace_back([&order, i](){
+            order.emplace_back(i);
+        });
+    }
+    queue.sendBatch(tasks.begin(), tasks.end());
+    queue.sendBatch({
+        std::function<void()>([&order](){ order.emplace_back(100); }),
+        std::function<void()>([&order](){ order.emplace_back(101); })
+    });
+    queue.sendBatch(tasks.end(), tasks.end());
+    queue.sendWait([](){});
+
+    ASSERT_EQ(order.size(), 102u);
+    for (int i = 0; i < 102; ++i)
+    {
+        EXPECT_EQ(order[i], i);
+    }
+}
+
+TEST(TaskQueueAllocatorTest, CustomMemoryResource)
+{
+    CountingMemoryResource resource;
+    {
+        gusc::Threads::TaskQueueOptions options;
+        options.memoryResource = &resource;
+        gusc::Threads::SerialTaskQueue queue { "SerialQueue", options };
+        std::array<char, 256> largeCapture {};
+        int result { 0 };
+        queue.send([&result](){
+            ++result;
+        });
+        queue.send([&result, largeCapture](){
+            result += largeCapture[0] + 1;
+        });
+        queue.sendDelayed([](){}, 1h);
+        EXPECT_EQ(queue.sendSync<int>([&result](){
+            return result;
+        }), 2);
+    }
+    EXPECT_GT(resource.allocationCount, 0U);
+    EXPECT_EQ(resource.allocationCount, resource.deallocationCount);
+}
+
+TEST(TaskQueueAllocatorTest, SteadyStateDoesNotAllocate)
+{
+    auto slab = gusc::Threads::SlabMemoryResource::getDefault();
+    gusc::Threads::SerialTaskQueue queue { "SerialQueue" };
+    std::atomic_int counter { 0 };
+    const auto runBurst = [&](){
+        for (int i = 0; i < 1000; ++i)
+        {
+            queue.send([&counter](){
+                ++counter;
+            });
+        }
+        queue.sendWait([](){});
+    };
+    // Pools grow until they can hold the peak number of tasks in flight, after that bursts are served from caches only
+    bool isSteady { false };
+    for (int i = 0; i < 50 && !isSteady; ++i)
+    {
+        const auto before = slab->getStatistics().systemAllocationCount;
+        runBurst();
+        isSteady = slab->getStatistics().systemAllocationCount == before;
+    }
+    EXPECT_TRUE(isSteady);
+}
+
 TEST_F(SerialTaskQueueTest, SendDelayed)
 {
     mock.setMock(&actualMock);
@@ -122,6 +371,1008 @@ TEST_F(SerialTaskQueueTest, SendDelayed)
     mock.setMock(nullptr);
 }
 
+TEST_F(SerialTaskQueueTest, CancelDelayed)
+{
+    auto capture = std::make_shared<std::vector<char>>(1024);
+    std::vector<gusc::Threads::TaskQueue::TaskHandle> handles;
+    for (int i = 0; i < 100; ++i)
+    {
+        handles.push_back(queue.sendDelayed([capture](){}, 30s));
+    }
+    std::atomic_bool isExecuted { false };
+    queue.sendDelayed([&isExecuted](){
+        isExecuted = true;
+    }, 20ms);
+    EXPECT_EQ(capture.use_count(), 101);
+    for (auto& handle : handles)
+    {
+        handle.cancel();
+        // Task is removed from the delayed queue right away
+        EXPECT_TRUE(handle.isExecuted());
+    }
+    EXPECT_EQ(capture.use_count(), 1);
+    std::this_thread::sleep_for(40ms);
+    queue.sendWait([](){});
+    EXPECT_TRUE(isExecuted);
+}
+
+TEST_F(SerialTaskQueueTest, SendDelayedWhileBusy)
+{
+    // Keep the queue thread busy with a task that keeps re-sending itself
+    std::atomic_bool isRunning { true };
+    std::function<void()> busyTask = [&](){
+        if (isRunning)
+        {
+            queue.send(busyTask);
+        }
+    };
+    queue.send(busyTask);
+
+    std::promise<void> delayedPromise;
+    auto delayedFuture = delayedPromise.get_future();
+    queue.sendDelayed([&](){
+        delayedPromise.set_value();
+    }, 10ms);
+    EXPECT_EQ(delayedFuture.wait_for(1s), std::future_status::ready);
+
+    isRunning = false;
+    queue.sendWait([](){});
+}
+
+TEST_F(SerialTaskQueueTest, Debounce)
+{
+    std::atomic_int executed { 0 };
+    std::atomic_int lastValue { -1 };
+    auto subQueue = queue.createSubQueue();
+    for (int i = 0; i < 1000; ++i)
+    {
+        queue.debounce(1, 20ms, [&executed, &lastValue, i](){
+            ++executed;
+            lastValue = i;
+        });
+        subQueue->debounce(1, 20ms, [&executed](){
+            ++executed;
+        });
+    }
+    std::this_thread::sleep_for(10ms);
+    EXPECT_EQ(executed, 0);
+    // Another event moves the timer
+    queue.debounce(1, 20ms, [&executed, &lastValue](){
+        ++executed;
+        lastValue = 1000;
+    });
+    subQueue->debounce(1, 20ms, [&executed](){
+        ++executed;
+    });
+    std::this_thread::sleep_for(15ms);
+    EXPECT_EQ(executed, 0);
+    std::this_thread::sleep_for(30ms);
+    queue.sendWait([](){});
+    EXPECT_EQ(executed, 2);
+    EXPECT_EQ(lastValue, 1000);
+}
+
+TEST_F(SerialTaskQueueTest, Throttle)
+{
+    std::atomic_int executed { 0 };
+    std::atomic_int lastValue { -1 };
+    for (int i = 0; i < 1000; ++i)
+    {
+        queue.throttle(1, 20ms, [&executed, &lastValue, i](){
+            ++executed;
+            lastValue = i;
+        });
+    }
+    // First one runs right away, the last one once the interval has passed
+    queue.sendWait([](){});
+    EXPECT_EQ(executed, 1);
+    EXPECT_EQ(lastValue, 0);
+    std::this_thread::sleep_for(40ms);
+    queue.sendWait([](){});
+    EXPECT_EQ(executed, 2);
+    EXPECT_EQ(lastValue, 999);
+    // Interval with no tasks ends the throttling
+    std::this_thread::sleep_for(30ms);
+    queue.throttle(1, 20ms, [&executed](){
+        ++executed;
+    });
+    queue.sendWait([](){});
+    EXPECT_EQ(executed, 3);
+}
+
+TEST_F(SerialTaskQueueTest, SendPeriodic)
+{
+    std::mutex mutex;
+    std::vector<std::chrono::steady_clock::time_point> times;
+    const auto start = std::chrono::steady_clock::now();
+    auto handle = queue.sendPeriodic([&](){
+        const std::lock_guard lock(mutex);
+        times.push_back(std::chrono::steady_clock::now());
+        // Running time does not push the schedule back
+        std::this_thread::sleep_for(2ms);
+    }, 10ms);
+    std::this_thread::sleep_for(105ms);
+    handle.cancel();
+    queue.sendWait([](){});
+    std::size_t count { 0 };
+    {
+        const std::lock_guard lock(mutex);
+        count = times.size();
+        ASSERT_GE(count, 5);
+        EXPECT_LE(count, 10);
+        // Executions stay on the start + n * period schedule, lateness of one execution does not carry over to the next ones
+        std::vector<std::chrono::steady_clock::duration> offsets;
+        for (const auto& time : times)
+        {
+            offsets.push_back((time - start) % 10ms);
+        }
+        std::sort(offsets.begin(), offsets.end());
+        EXPECT_LT(offsets[offsets.size() / 2], 3ms);
+    }
+    std::this_thread::sleep_for(30ms);
+    queue.sendWait([](){});
+    const std::lock_guard lock(mutex);
+    EXPECT_EQ(times.size(), count);
+    EXPECT_TRUE(handle.isExecuted());
+}
+
+TEST_F(SerialTaskQueueTest, SendIdle)
+{
+    std::promise<void> blockPromise;
+    auto blockFuture = blockPromise.get_future().share();
+    std::vector<int> order;
+    queue.send([blockFuture](){
+        blockFuture.wait();
+    });
+    queue.sendIdle([&order](){
+        order.push_back(2);
+    });
+    queue.send([&order](){
+        order.push_back(1);
+    });
+    blockPromise.set_value();
+    queue.sendWait([](){});
+    // Idle task waits until the queue has nothing else to do
+    std::this_thread::sleep_for(10ms);
+    queue.sendWait([&order](){
+        order.push_back(3);
+    });
+    EXPECT_EQ(order, std::vector<int>({ 1, 2, 3 }));
+}
+
+TEST_F(SerialTaskQueueTest, CancelAllFromBatch)
+{
+    std::promise<void> cancelPromise;
+    auto cancelFuture = cancelPromise.get_future();
+    std::atomic_bool isCancelledTaskExecuted { false };
+    std::vector<std::function<void()>> tasks {
+        [&](){
+            queue.cancelAll();
+            cancelPromise.set_value();
+        },
+        [&](){
+            isCancelledTaskExecuted = true;
+        }
+    };
+    queue.sendBatch(tasks.begin(), tasks.end());
+    cancelFuture.wait();
+    queue.sendWait([](){});
+
+    EXPECT_FALSE(isCancelledTaskExecuted);
+}
+
+TEST_F(SerialTaskQueueTest, SubQueueDestroyedByPrecedingTask)
+{
+    std::promise<void> blockPromise;
+    auto blockFuture = blockPromise.get_future().share();
+    queue.send([blockFuture](){
+        blockFuture.wait();
+    });
+    auto subQueue = queue.createSubQueue();
+    std::atomic_bool isSubQueueTaskExecuted { false };
+    subQueue->send([&](){
+        isSubQueueTaskExecuted = true;
+    });
+    queue.send([&](){
+        subQueue.reset();
+    });
+    blockPromise.set_value();
+    queue.sendWait([](){});
+
+    EXPECT_FALSE(isSubQueueTaskExecuted);
+}
+
+TEST_F(SerialTaskQueueTest, ManySubQueues)
+{
+    constexpr int numSubQueues { 2000 };
+    constexpr int numTasks { 100 };
+
+    std::vector<std::shared_ptr<gusc::Threads::TaskQueue>> subQueues;
+    for (int i = 0; i < numSubQueues; ++i)
+    {
+        subQueues.push_back(queue.createSubQueue());
+    }
+    // Only a few sub-queues have tasks, each keeps it's own order
+    std::vector<int> first;
+    std::vector<int> last;
+    for (int i = 0; i < numTasks; ++i)
+    {
+        subQueues.front()->send([&first, i](){
+            first.push_back(i);
+        });
+        subQueues.back()->send([&last, i](){
+            last.push_back(i);
+        });
+    }
+    // Sub-queue of a sub-queue with a delayed task
+    auto nestedParentQueue = subQueues[numSubQueues / 2];
+    auto nestedQueue = nestedParentQueue->createSubQueue();
+    std::promise<void> delayedPromise;
+    auto delayedFuture = delayedPromise.get_future();
+    nestedQueue->sendDelayed([&](){
+        delayedPromise.set_value();
+    }, 10ms);
+    // Destroyed sub-queues are forgotten right away
+    subQueues.erase(subQueues.begin() + 1, subQueues.end() - 1);
+    EXPECT_EQ(delayedFuture.wait_for(1s), std::future_status::ready);
+    subQueues.front()->sendWait([](){});
+    subQueues.back()->sendWait([](){});
+
+    ASSERT_EQ(first.size(), static_cast<std::size_t>(numTasks));
+    ASSERT_EQ(last.size(), static_cast<std::size_t>(numTasks));
+    for (int i = 0; i < numTasks; ++i)
+    {
+        EXPECT_EQ(first[i], i);
+        EXPECT_EQ(last[i], i);
+    }
+}
+
+TEST(TaskQueueFairShareTest, WeightedSubQueues)
+{
+    constexpr int numTasks { 1000 };
+    constexpr int sampleCount { 700 };
+    const std::size_t weights[] { 1, 2, 4 };
+
+    std::promise<void> startPromise;
+    auto startFuture = startPromise.get_future();
+    std::promise<void> blockPromise;
+    auto blockFuture = blockPromise.get_future().share();
+    std::array<std::atomic_int, 3> executed {};
+    std::atomic_int totalExecuted { 0 };
+    std::array<int, 3> sample {};
+    // Every task is charged the same, so the shares don't depend on how long the tasks took (or if the thread got preempted)
+    gusc::Threads::TaskQueueOptions options;
+    options.fairShareCost = gusc::Threads::FairShareCost::TaskCount;
+    gusc::Threads::SerialTaskQueue queue { "SerialQueue", options };
+    queue.send([&startPromise, blockFuture](){
+        startPromise.set_value();
+        blockFuture.wait();
+    });
+    startFuture.wait();
+    std::vector<std::shared_ptr<gusc::Threads::TaskQueue>> subQueues;
+    for (std::size_t q = 0; q < 3; ++q)
+    {
+        subQueues.push_back(queue.createSubQueue(weights[q]));
+    }
+    // A chatty parent queue competes too and the sub-queue with the smallest weight has the longest tasks
+    for (int i = 0; i < numTasks; ++i)
+    {
+        queue.send([](){});
+        for (std::size_t q = 0; q < 3; ++q)
+        {
+            subQueues[q]->send([&, q](){
+                if (q == 0)
+                {
+                    spinFor(20us);
+                }
+                ++executed[q];
+                if (++totalExecuted == sampleCount)
+                {
+                    for (std::size_t j = 0; j < 3; ++j)
+                    {
+                        sample[j] = executed[j];
+                    }
+                }
+            });
+        }
+    }
+    blockPromise.set_value();
+    while (queue.sendSync<int>([&](){ return totalExecuted.load(); }) < sampleCount)
+    {
+        std::this_thread::sleep_for(1ms);
+    }
+    for (auto& subQueue : subQueues)
+    {
+        subQueue->cancelAll();
+    }
+    queue.cancelAll();
+
+    // Busy sub-queues execute tasks in proportion to their weights: 100 : 200 : 400
+    EXPECT_NEAR(sample[0], 100, 2);
+    EXPECT_NEAR(sample[1], 200, 2);
+    EXPECT_NEAR(sample[2], 400, 2);
+    for (std::size_t q = 0; q < 3; ++q)
+    {
+        const auto statistics = subQueues[q]->getStatistics();
+        EXPECT_GE(statistics.executedCount, static_cast<std::size_t>(sample[q]));
+        EXPECT_GT(statistics.totalWaitTime.count(), 0);
+        EXPECT_GE(statistics.maxWaitTime * static_cast<long>(statistics.executedCount), statistics.totalWaitTime);
+    }
+}
+
+TEST_F(SerialTaskQueueTest, SelfSendingRootDoesNotStarveSubQueue)
+{
+    auto subQueue = queue.createSubQueue(2);
+    std::atomic_bool isStopping { false };
+    std::atomic_int rootExecuted { 0 };
+    // Root task keeps posting a follow-up to it's own queue, which would be appended to the running batch if it was never charged for it
+    std::function<void()> postNext = [&](){
+        ++rootExecuted;
+        if (!isStopping)
+        {
+            queue.send(postNext);
+        }
+    };
+    queue.send(postNext);
+    while (rootExecuted < 100)
+    {
+        std::this_thread::yield();
+    }
+    std::promise<void> promise;
+    auto future = promise.get_future();
+    subQueue->send([&promise](){
+        promise.set_value();
+    });
+    EXPECT_EQ(future.wait_for(1s), std::future_status::ready);
+    isStopping = true;
+    queue.sendWait([](){});
+    // Task a sub-queue task sends to the root queue is not executed and accounted as part of the sub-queue's batch
+    const auto executedCount = subQueue->getStatistics().executedCount;
+    subQueue->sendWait([this](){
+        queue.send([](){});
+    });
+    queue.sendWait([](){});
+    EXPECT_EQ(subQueue->getStatistics().executedCount, executedCount + 1);
+}
+
+TEST(TaskQueueLifetimeTest, SubQueueOutlivesParent)
+{
+    std::shared_ptr<gusc::Threads::TaskQueue> subQueue;
+    {
+        gusc::Threads::SerialTaskQueue serialQueue { "SerialQueue" };
+        subQueue = serialQueue.createSubQueue();
+        subQueue->sendWait([](){});
+    }
+    EXPECT_FALSE(subQueue->getAcceptsTasks());
+    EXPECT_THROW(subQueue->send([](){}), std::runtime_error);
+}
+
+TEST_F(SerialTaskQueueTest, SendWithPriority)
+{
+    using Priority = gusc::Threads::TaskQueue::Priority;
+    std::promise<void> blockPromise;
+    auto blockFuture = blockPromise.get_future();
+    queue.send([&blockFuture](){
+        blockFuture.wait();
+    });
+    std::vector<int> order;
+    for (int i = 0; i < 3; ++i)
+    {
+        queue.send([&order, i](){
+            order.push_back(20 + i);
+        }, Priority::Low);
+        queue.send([&order, i](){
+            order.push_back(10 + i);
+        });
+        queue.send([&order, i](){
+            order.push_back(i);
+        }, Priority::High);
+    }
+    auto handle = queue.sendAsync<int>([](){
+        return 1;
+    }, Priority::High);
+    blockPromise.set_value();
+    EXPECT_EQ(handle.getValue(), 1);
+    queue.sendWait([](){}, Priority::Low);
+    EXPECT_EQ(order, std::vector<int>({ 0, 1, 2, 10, 11, 12, 20, 21, 22 }));
+}
+
+TEST(TaskQueuePriorityTest, Aging)
+{
+    using Priority = gusc::Threads::TaskQueue::Priority;
+    constexpr int numTasks { 500 };
+    // Everything the tasks refer to outlives the queue, so that tasks left in the queue never refer to destroyed objects
+    std::promise<void> startPromise;
+    auto startFuture = startPromise.get_future();
+    std::promise<void> blockPromise;
+    auto blockFuture = blockPromise.get_future();
+    std::atomic_int highExecuted { 0 };
+    std::atomic_int highExecutedBeforeLow { -1 };
+    gusc::Threads::TaskQueueOptions options;
+    options.priorityAgingInterval = 2ms;
+    gusc::Threads::SerialTaskQueue queue { "SerialQueue", options };
+    queue.send([&startPromise, &blockFuture](){
+        startPromise.set_value();
+        blockFuture.wait();
+    }, Priority::High);
+    // Workload is only sent once the blocker is running, so that none of it can overtake the blocker
+    startFuture.wait();
+    for (int i = 0; i < numTasks; ++i)
+    {
+        queue.send([&](){
+            spinFor(100us);
+            ++highExecuted;
+        }, Priority::High);
+    }
+    queue.send([&](){
+        highExecutedBeforeLow = highExecuted.load();
+    }, Priority::Low);
+    blockPromise.set_value();
+    queue.sendWait([](){}, Priority::Low);
+    // Low priority task is passed over for about 2ms, not until all the high priority tasks have run
+    EXPECT_GE(highExecutedBeforeLow, 0);
+    EXPECT_LT(highExecutedBeforeLow, numTasks / 2);
+}
+
+TEST(TaskQueuePriorityTest, SelfSendingTaskDoesNotBlockOtherPriorities)
+{
+    using Priority = gusc::Threads::TaskQueue::Priority;
+    gusc::Threads::TaskQueueOptions options;
+    options.priorityAgingInterval = 2ms;
+    gusc::Threads::SerialTaskQueue queue { "SerialQueue", options };
+    std::atomic_bool isStopping { false };
+    std::atomic_int executed { 0 };
+    // Normal priority task keeps posting a follow-up to it's own queue, which would be appended to the running batch forever
+    std::function<void()> postNext = [&](){
+        ++executed;
+        if (!isStopping)
+        {
+            queue.send(postNext);
+        }
+    };
+    queue.send(postNext);
+    while (executed < 100)
+    {
+        std::this_thread::yield();
+    }
+    std::promise<void> highPromise;
+    auto highFuture = highPromise.get_future();
+    queue.send([&highPromise](){
+        highPromise.set_value();
+    }, Priority::High);
+    EXPECT_EQ(highFuture.wait_for(1s), std::future_status::ready);
+    std::promise<void> delayedPromise;
+    auto delayedFuture = delayedPromise.get_future();
+    queue.sendDelayed([&delayedPromise](){
+        delayedPromise.set_value();
+    }, 1ms, Priority::High);
+    EXPECT_EQ(delayedFuture.wait_for(1s), std::future_status::ready);
+    // Low priority task ages past the busy normal priority level
+    std::promise<void> lowPromise;
+    auto lowFuture = lowPromise.get_future();
+    queue.send([&lowPromise](){
+        lowPromise.set_value();
+    }, Priority::Low);
+    EXPECT_EQ(lowFuture.wait_for(1s), std::future_status::ready);
+    isStopping = true;
+    queue.sendWait([](){});
+}
+
+TEST(TaskQueueCapacityTest, Backpressure)
+{
+    gusc::Threads::TaskQueueOptions options;
+    options.capacity = 2;
+    gusc::Threads::SerialTaskQueue queue { "SerialQueue", options };
+    std::promise<void> blockPromise;
+    auto blockFuture = blockPromise.get_future();
+    std::promise<void> startedPromise;
+    queue.send([&blockFuture, &startedPromise](){
+        startedPromise.set_value();
+        blockFuture.wait();
+    });
+    // Task that's being executed does not take room in the queue
+    startedPromise.get_future().wait();
+    std::atomic_int executed { 0 };
+    EXPECT_TRUE(queue.trySend([&executed](){
+        ++executed;
+    }));
+    EXPECT_TRUE(queue.trySend([&executed](){
+        ++executed;
+    }));
+    EXPECT_FALSE(queue.trySend([&executed](){
+        ++executed;
+    }));
+    const auto timeStart = std::chrono::steady_clock::now();
+    EXPECT_FALSE(queue.trySendFor([&executed](){
+        ++executed;
+    }, 10ms));
+    EXPECT_GE(std::chrono::steady_clock::now() - timeStart, 10ms);
+    std::atomic_bool isSent { false };
+    std::thread producer([&](){
+        queue.send([&executed](){
+            ++executed;
+        });
+        isSent = true;
+    });
+    std::this_thread::sleep_for(10ms);
+    EXPECT_FALSE(isSent);
+    blockPromise.set_value();
+    producer.join();
+    EXPECT_TRUE(isSent);
+    queue.sendWait([](){});
+    EXPECT_EQ(executed, 3);
+}
+
+TEST(TaskQueueCapacityTest, CapacitySize)
+{
+    gusc::Threads::TaskQueueOptions options;
+    options.capacitySize = 1024;
+    gusc::Threads::SerialTaskQueue queue { "SerialQueue", options };
+    std::promise<void> blockPromise;
+    auto blockFuture = blockPromise.get_future();
+    std::promise<void> startedPromise;
+    queue.send([&blockFuture, &startedPromise](){
+        startedPromise.set_value();
+        blockFuture.wait();
+    });
+    startedPromise.get_future().wait();
+    std::array<char, 800> payload {};
+    // A task bigger than the capacity is still admitted into an empty queue
+    EXPECT_TRUE(queue.trySend([payload](){}));
+    EXPECT_FALSE(queue.trySend([payload](){}));
+    blockPromise.set_value();
+    queue.sendWait([](){});
+    EXPECT_TRUE(queue.trySend([payload](){}));
+}
+
+TEST(TaskQueueLoadSheddingTest, RejectByDepth)
+{
+    using Priority = gusc::Threads::TaskQueue::Priority;
+    gusc::Threads::TaskQueueOptions options;
+    options.loadSheddingDepth = 4;
+    gusc::Threads::SerialTaskQueue queue { "SerialQueue", options };
+    std::promise<void> blockPromise;
+    auto blockFuture = blockPromise.get_future();
+    std::promise<void> startedPromise;
+    queue.send([&blockFuture, &startedPromise](){
+        startedPromise.set_value();
+        blockFuture.wait();
+    });
+    startedPromise.get_future().wait();
+    std::atomic_int executed { 0 };
+    std::atomic_int cancelled { 0 };
+    const auto task = [&executed](){
+        ++executed;
+    };
+    const auto onCancel = [&cancelled](){
+        ++cancelled;
+    };
+    for (int i = 0; i < 4; ++i)
+    {
+        queue.send(task);
+    }
+    // Low priority goes first
+    EXPECT_FALSE(queue.sendSheddable(task, onCancel, Priority::Low));
+    EXPECT_TRUE(queue.sendSheddable(task, onCancel, Priority::Normal));
+    EXPECT_EQ(cancelled, 1);
+    for (int i = 0; i < 3; ++i)
+    {
+        queue.send(task);
+    }
+    EXPECT_EQ(queue.getStatistics().pendingCount, 8);
+    EXPECT_FALSE(queue.sendSheddable(task, onCancel, Priority::Normal));
+    EXPECT_TRUE(queue.sendSheddable(task, onCancel, Priority::High));
+    EXPECT_EQ(cancelled, 2);
+    blockPromise.set_value();
+    queue.sendWait([](){});
+    EXPECT_EQ(executed, 9);
+    EXPECT_EQ(queue.getStatistics().rejectedCount, 2);
+    EXPECT_EQ(queue.getStatistics().pendingCount, 0);
+}
+
+TEST(TaskQueueLoadSheddingTest, ShedByAge)
+{
+    using Priority = gusc::Threads::TaskQueue::Priority;
+    gusc::Threads::TaskQueueOptions options;
+    options.loadSheddingAge = 10ms;
+    std::promise<void> startPromise;
+    auto startFuture = startPromise.get_future();
+    std::promise<void> blockPromise;
+    auto blockFuture = blockPromise.get_future();
+    std::promise<void> donePromise;
+    auto doneFuture = donePromise.get_future();
+    std::atomic_int executed { 0 };
+    std::atomic_int cancelled { 0 };
+    gusc::Threads::SerialTaskQueue queue { "SerialQueue", options };
+    queue.send([&startPromise, &blockFuture](){
+        startPromise.set_value();
+        blockFuture.wait();
+    });
+    // Blocker has to be running, otherwise the tasks might be taken in the same batch without waiting at all
+    startFuture.wait();
+    const auto task = [&executed](){
+        ++executed;
+    };
+    const auto onCancel = [&cancelled](){
+        ++cancelled;
+    };
+    queue.sendSheddable(task, onCancel, Priority::Low);
+    queue.sendSheddable(task, onCancel, Priority::High);
+    queue.send([&executed, &donePromise](){
+        ++executed;
+        donePromise.set_value();
+    }, Priority::Low);
+    // Tasks wait for at least 20ms, which is enough to shed low priority, but not high priority (that takes 40ms)
+    std::this_thread::sleep_for(20ms);
+    blockPromise.set_value();
+    // Nothing is sent until the waiting tasks are taken, a new task in their batch would make it look like they haven't waited
+    doneFuture.wait();
+    queue.sendWait([](){});
+    EXPECT_EQ(executed, 2);
+    EXPECT_EQ(cancelled, 1);
+    EXPECT_EQ(queue.getStatistics().shedCount, 1);
+}
+
+TEST_F(SerialTaskQueueTest, SendCoalesced)
+{
+    std::promise<void> blockPromise;
+    auto blockFuture = blockPromise.get_future();
+    queue.send([&blockFuture](){
+        blockFuture.wait();
+    });
+    std::vector<std::string> order;
+    queue.send([&order](){
+        order.push_back("first");
+    });
+    EXPECT_TRUE(queue.sendCoalesced(1, [&order](){
+        order.push_back("a1");
+    }));
+    EXPECT_TRUE(queue.sendCoalesced(2, [&order](){
+        order.push_back("b1");
+    }));
+    // Replaced task keeps the position of the original
+    EXPECT_FALSE(queue.sendCoalesced(1, [&order](){
+        order.push_back("a2");
+    }));
+    EXPECT_FALSE(queue.sendCoalesced(2, [&order](){
+        order.push_back("b2");
+    }, gusc::Threads::CoalescingPolicy::Drop));
+    queue.send([&order](){
+        order.push_back("last");
+    });
+    blockPromise.set_value();
+    queue.sendWait([](){});
+    EXPECT_EQ(order, std::vector<std::string>({ "first", "a2", "b1", "last" }));
+    // Once executed the key can be sent again
+    EXPECT_TRUE(queue.sendCoalesced(1, [&order](){
+        order.push_back("a3");
+    }));
+    queue.sendWait([](){});
+    EXPECT_EQ(order.back(), "a3");
+}
+
+TEST_F(SerialTaskQueueTest, SendCoalescedCancelled)
+{
+    std::promise<void> blockPromise;
+    auto blockFuture = blockPromise.get_future();
+    queue.send([&blockFuture](){
+        blockFuture.wait();
+    });
+    int executed { 0 };
+    EXPECT_TRUE(queue.sendCoalesced(1, [&executed](){
+        ++executed;
+    }));
+    queue.cancelAll();
+    // Cancelled task does not block the key
+    EXPECT_TRUE(queue.sendCoalesced(1, [&executed](){
+        ++executed;
+    }));
+    blockPromise.set_value();
+    queue.sendWait([](){});
+    EXPECT_EQ(executed, 1);
+}
+
+TEST(TaskQueuePeriodicTest, Overrun)
+{
+    std::atomic_int fixedRate { 0 };
+    std::atomic_int catchUp { 0 };
+    std::atomic_int fixedDelay { 0 };
+    auto makeTask = [](std::atomic_int& counter){
+        return [&counter](){
+            // First execution overruns 3.5 periods
+            if (counter++ == 0)
+            {
+                std::this_thread::sleep_for(45ms);
+            }
+        };
+    };
+    gusc::Threads::SerialTaskQueue fixedRateQueue;
+    gusc::Threads::SerialTaskQueue catchUpQueue;
+    gusc::Threads::SerialTaskQueue fixedDelayQueue;
+    auto h1 = fixedRateQueue.sendPeriodic(makeTask(fixedRate), 10ms, gusc::Threads::PeriodicPolicy::FixedRate);
+    auto h2 = catchUpQueue.sendPeriodic(makeTask(catchUp), 10ms, gusc::Threads::PeriodicPolicy::FixedRateCatchUp);
+    auto h3 = fixedDelayQueue.sendPeriodic(makeTask(fixedDelay), 10ms, gusc::Threads::PeriodicPolicy::FixedDelay);
+    std::this_thread::sleep_for(93ms);
+    h1.cancel();
+    h2.cancel();
+    h3.cancel();
+    fixedRateQueue.sendWait([](){});
+    catchUpQueue.sendWait([](){});
+    fixedDelayQueue.sendWait([](){});
+    // Fixed rate skips the missed executions (10, 60, 70, 80, 90), catch up makes up for them (10, 55 x 4, 60, 70, 80, 90)
+    // and fixed delay counts from the end of the overrun (10, 65, 75, 85)
+    EXPECT_GE(fixedRate, 4);
+    EXPECT_LE(fixedRate, 6);
+    EXPECT_GE(catchUp, fixedRate + 3);
+    EXPECT_GE(fixedDelay, 3);
+    EXPECT_LE(fixedDelay, 5);
+}
+
+TEST(TaskQueueIdleTest, TimeSlice)
+{
+    gusc::Threads::TaskQueueOptions options;
+    options.idleTimeSlice = 20ms;
+    gusc::Threads::SerialTaskQueue queue { "SerialQueue", options };
+    std::atomic_int sliceCount { 0 };
+    std::promise<void> donePromise;
+    auto doneFuture = donePromise.get_future();
+    const auto start = std::chrono::steady_clock::now();
+    queue.sendIdle([&](const gusc::Threads::TaskQueue::IdleDeadline& deadline){
+        ++sliceCount;
+        while (!deadline.getShouldYield())
+        {}
+        if (std::chrono::steady_clock::now() - start < 70ms)
+        {
+            return true;
+        }
+        donePromise.set_value();
+        return false;
+    });
+    std::this_thread::sleep_for(10ms);
+    // Idle task yields to a new task before it's time slice has ended
+    const auto sendTime = std::chrono::steady_clock::now();
+    const auto latency = queue.sendAsync<std::chrono::steady_clock::duration>([sendTime](){
+        return std::chrono::steady_clock::now() - sendTime;
+    }).getValue();
+    EXPECT_LT(latency, 10ms);
+    doneFuture.wait();
+    EXPECT_GE(sliceCount, 4);
+}
+
+TEST(TaskQueueTimingWheelTest, SendDelayed)
+{
+    gusc::Threads::TaskQueueOptions options;
+    options.timerBackend = gusc::Threads::TimerBackend::TimingWheel;
+    options.timerResolution = 1ms;
+    gusc::Threads::SerialTaskQueue queue { "SerialQueue", options };
+    auto subQueue = queue.createSubQueue();
+    std::mutex mutex;
+    std::vector<int> order;
+    const auto start = std::chrono::steady_clock::now();
+    auto makeTask = [&](int delay){
+        return [&, delay](){
+            // Timing wheel rounds up to whole ticks, so the task is never moved to the task queue early
+            EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(delay));
+            const std::lock_guard lock(mutex);
+            order.push_back(delay);
+        };
+    };
+    // 80 ms is past the first level of the wheel, so it's moved down a level before it expires
+    queue.sendDelayed(makeTask(80), 80ms);
+    queue.sendDelayed(makeTask(30), 30ms);
+    subQueue->sendDelayed(makeTask(50), 50ms);
+    queue.sendDelayed(makeTask(10), 10ms);
+    auto handle = queue.sendDelayed(makeTask(20), 20ms);
+    handle.cancel();
+    EXPECT_TRUE(handle.isExecuted());
+    auto capture = std::make_shared<int>(0);
+    auto farHandle = queue.sendDelayed([capture](){}, 10min);
+    farHandle.cancel();
+    EXPECT_EQ(capture.use_count(), 1);
+    queue.sendDelayed(makeTask(600000), 10min);
+    std::this_thread::sleep_for(120ms);
+    queue.sendWait([](){});
+    const std::lock_guard lock(mutex);
+    EXPECT_EQ(order, std::vector<int>({ 10, 30, 50, 80 }));
+}
+
+TEST(TaskQueueTimerServiceTest, SendDelayed)
+{
+    gusc::Threads::TimerService service;
+    gusc::Threads::TaskQueueOptions options;
+    options.timerService = &service;
+    gusc::Threads::SerialTaskQueue serialQueue { "SerialQueue", options };
+    gusc::Threads::ParallelTaskQueue parallelQueue { "ParallelQueue", 4, options };
+    auto subQueue = serialQueue.createSubQueue();
+    std::mutex mutex;
+    std::vector<int> order;
+    const auto start = std::chrono::steady_clock::now();
+    auto makeTask = [&](int delay){
+        return [&, delay](){
+            EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(delay));
+            const std::lock_guard lock(mutex);
+            order.push_back(delay);
+        };
+    };
+    serialQueue.sendDelayed(makeTask(60), 60ms);
+    serialQueue.sendDelayed(makeTask(20), 20ms);
+    subQueue->sendDelayed(makeTask(40), 40ms);
+    parallelQueue.sendDelayed(makeTask(30), 30ms);
+    parallelQueue.sendDelayed(makeTask(10), 10ms);
+    auto handle = serialQueue.sendDelayed(makeTask(5), 5ms);
+    handle.cancel();
+    EXPECT_TRUE(handle.isExecuted());
+    // Every queue has a single timer in the service no matter how many delayed tasks it has
+    EXPECT_EQ(service.getTimerCount(), 3);
+    std::this_thread::sleep_for(100ms);
+    serialQueue.sendWait([](){});
+    parallelQueue.sendWait([](){});
+    {
+        const std::lock_guard lock(mutex);
+        EXPECT_EQ(order, std::vector<int>({ 10, 20, 30, 40, 60 }));
+    }
+    EXPECT_EQ(service.getTimerCount(), 0);
+    // Destroying a queue removes it's timer from the service
+    {
+        gusc::Threads::SerialTaskQueue queue { "SerialQueue", options };
+        queue.sendDelayed([](){}, 10min);
+        EXPECT_EQ(service.getTimerCount(), 1);
+    }
+    EXPECT_EQ(service.getTimerCount(), 0);
+}
+
+TEST(TaskQueueTimerPrecisionTest, SendDelayed)
+{
+    gusc::Threads::TaskQueueOptions options;
+    options.timerPrecision = gusc::Threads::TimerPrecision::High;
+    gusc::Threads::SerialTaskQueue queue { "SerialQueue", options };
+    for (int i = 0; i < 10; ++i)
+    {
+        std::promise<std::chrono::steady_clock::time_point> promise;
+        auto future = promise.get_future();
+        const auto dueTime = std::chrono::steady_clock::now() + 5ms;
+        queue.sendDelayed([&promise](){
+            promise.set_value(std::chrono::steady_clock::now());
+        }, 5ms);
+        const auto executedAt = future.get();
+        // Task is never early and sleeping on the precise timer does not stop the thread from being late on a busy machine,
+        // so only the gross lateness of a missed wake-up is checked here
+        EXPECT_GE(executedAt, dueTime);
+        EXPECT_LT(executedAt - dueTime, 20ms);
+    }
+    // Thread sleeping on the precise timer is woken up by new tasks
+    queue.sendDelayed([](){}, 10min);
+    queue.sendWait([](){});
+    std::promise<void> promise;
+    auto future = promise.get_future();
+    std::this_thread::sleep_for(10ms);
+    queue.send([&promise](){
+        promise.set_value();
+    });
+    EXPECT_EQ(future.wait_for(1s), std::future_status::ready);
+}
+
+#if defined(__linux__)
+TEST(TaskQueueTimerPrecisionTest, RestoreTimerSlack)
+{
+    // Queue runs on the calling thread, which has to get it's own timer slack back afterwards
+    const auto slack = prctl(PR_GET_TIMERSLACK, 0UL, 0UL, 0UL, 0UL);
+    int slackWhileRunning { -1 };
+    {
+        gusc::Threads::ThisThread tt;
+        gusc::Threads::TaskQueueOptions options;
+        options.timerPrecision = gusc::Threads::TimerPrecision::High;
+        gusc::Threads::SerialTaskQueue queue { tt, options };
+        queue.sendDelayed([&](){
+            slackWhileRunning = prctl(PR_GET_TIMERSLACK, 0UL, 0UL, 0UL, 0UL);
+            tt.stop();
+        }, 5ms);
+        tt.start();
+    }
+    EXPECT_EQ(slackWhileRunning, 1);
+    EXPECT_EQ(prctl(PR_GET_TIMERSLACK, 0UL, 0UL, 0UL, 0UL), slack);
+}
+#endif
+
+TEST(TaskQueueTimerCoalescingTest, SendDelayedWithTolerance)
+{
+    for (const auto backend : { gusc::Threads::TimerBackend::OrderedSet, gusc::Threads::TimerBackend::TimingWheel })
+    {
+        gusc::Threads::TaskQueueOptions options;
+        options.timerBackend = backend;
+        gusc::Threads::SerialTaskQueue queue { "SerialQueue", options };
+        std::vector<std::chrono::steady_clock::time_point> times;
+        const auto start = std::chrono::steady_clock::now();
+        queue.sendWait([&](){
+            // Timeouts a millisecond apart with windows that overlap
+            for (int i = 0; i < 40; ++i)
+            {
+                queue.sendDelayed([&, i](){
+                    const auto timeNow = std::chrono::steady_clock::now();
+                    EXPECT_GE(timeNow - start, std::chrono::milliseconds(10 + i));
+                    times.push_back(timeNow);
+                }, std::chrono::milliseconds(10 + i), 20ms);
+            }
+        });
+        std::this_thread::sleep_for(150ms);
+        queue.sendWait([](){});
+        ASSERT_EQ(times.size(), 40);
+        // Tasks that are moved to the task queue together are executed back to back
+        std::size_t wakeUpCount { 1 };
+        for (std::size_t i = 1; i < times.size(); ++i)
+        {
+            if (times[i] - times[i - 1] > 500us)
+            {
+                ++wakeUpCount;
+            }
+        }
+        EXPECT_LE(wakeUpCount, 8);
+    }
+}
+
+TEST(TaskQueueDeadlineTest, EarliestDeadlineFirst)
+{
+    gusc::Threads::TaskQueueOptions options;
+    options.schedulingMode = gusc::Threads::SchedulingMode::EarliestDeadlineFirst;
+    gusc::Threads::SerialTaskQueue queue { "SerialQueue", options };
+    std::promise<void> blockPromise;
+    auto blockFuture = blockPromise.get_future();
+    queue.send([&blockFuture](){
+        blockFuture.wait();
+    });
+    std::vector<int> order;
+    const auto timeNow = std::chrono::steady_clock::now();
+    queue.send([&order](){
+        order.push_back(0);
+    });
+    queue.sendWithDeadline([&order](){
+        order.push_back(3);
+    }, timeNow + 30s);
+    queue.sendWithDeadline([&order](){
+        order.push_back(1);
+    }, timeNow + 10s);
+    queue.sendWithDeadline([&order](){
+        order.push_back(2);
+    }, timeNow + 20s);
+    queue.sendWithDeadline([&order](){
+        order.push_back(4);
+    }, timeNow + 30s);
+    // This one has already missed it's deadline
+    queue.sendWithDeadline([&order](){
+        order.push_back(-1);
+    }, timeNow - 1s);
+    blockPromise.set_value();
+    queue.sendWait([](){});
+    EXPECT_EQ(order, std::vector<int>({ -1, 1, 2, 3, 4, 0 }));
+    EXPECT_EQ(queue.getStatistics().deadlineMissCount, 1);
+}
+
+TEST_F(SerialTaskQueueTest, SendWithDeadline)
+{
+    std::promise<void> blockPromise;
+    auto blockFuture = blockPromise.get_future();
+    queue.send([&blockFuture](){
+        blockFuture.wait();
+    });
+    std::vector<int> order;
+    const auto timeNow = std::chrono::steady_clock::now();
+    auto subQueue = queue.createSubQueue();
+    queue.send([&order](){
+        order.push_back(0);
+    });
+    queue.sendWithDeadline([&order](){
+        order.push_back(1);
+    }, timeNow + 10s);
+    subQueue->sendWithDeadline([](){}, timeNow - 1s);
+    blockPromise.set_value();
+    subQueue->sendWait([](){});
+    queue.sendWait([](){});
+    // Without earliest deadline first scheduling deadlines don't change the order, but misses are still counted per queue
+    EXPECT_EQ(order, std::vector<int>({ 0, 1 }));
+    EXPECT_EQ(queue.getStatistics().deadlineMissCount, 0);
+    EXPECT_EQ(subQueue->getStatistics().deadlineMissCount, 1);
+}
+
 TEST_F(SerialTaskQueueTest, Exceptions)
 {
     mock.setMock(&actualMock);
@@ -257,6 +1508,107 @@ TEST_F(ParallelTaskQueueTest, SendAsync)
     mock.setMock(nullptr);
 }
 
+TEST_F(ParallelTaskQueueTest, SendAsyncBatch)
+{
+    std::vector<std::function<int()>> tasks;
+    for (int i = 0; i < 16; ++i)
+    {
+        tasks.emplace_back([i](){
+            return i * 2;
+        });
+    }
+    auto handles = queue.sendAsyncBatch<int>(tasks.begin(), tasks.end());
+
+    ASSERT_EQ(handles.size(), tasks.size());
+    for (int i = 0; i < 16; ++i)
+    {
+        EXPECT_EQ(handles[i].getValue(), i * 2);
+    }
+}
+
+TEST_F(ParallelTaskQueueTest, SendAsyncWithExpiry)
+{
+    constexpr int numThreads { 4 };
+    // Keep all the threads busy until the tasks have expired
+    std::promise<void> blockPromise;
+    auto blockFuture = blockPromise.get_future().share();
+    for (int i = 0; i < numThreads; ++i)
+    {
+        queue.send([blockFuture](){
+            blockFuture.wait();
+        });
+    }
+    const auto timeNow = std::chrono::steady_clock::now();
+    std::atomic_int executed { 0 };
+    auto expiredHandle = queue.sendAsync<int>([&executed](){
+        ++executed;
+        return 1;
+    }, timeNow + 10ms);
+    auto handle = queue.sendAsync<int>([&executed](){
+        ++executed;
+        return 2;
+    }, timeNow + 1h);
+    std::this_thread::sleep_for(20ms);
+    blockPromise.set_value();
+    EXPECT_EQ(handle.getValue(), 2);
+    try
+    {
+        expiredHandle.getValue();
+        FAIL() << "Expired task was executed";
+    }
+    catch (const std::future_error& e)
+    {
+        EXPECT_EQ(e.code(), std::future_errc::broken_promise);
+    }
+    EXPECT_EQ(executed, 1);
+    EXPECT_EQ(queue.getStatistics().expiredCount, 1);
+}
+
+TEST_F(ParallelTaskQueueTest, SendWithPriority)
+{
+    using Priority = gusc::Threads::TaskQueue::Priority;
+    constexpr int numTasks { 32 };
+    constexpr int numThreads { 4 };
+    // Keep all the threads busy until every task has been sent
+    std::promise<void> blockPromise;
+    auto blockFuture = blockPromise.get_future().share();
+    std::atomic_int blockedCount { 0 };
+    for (int i = 0; i < numThreads; ++i)
+    {
+        queue.send([&blockedCount, blockFuture](){
+            ++blockedCount;
+            blockFuture.wait();
+        });
+    }
+    while (blockedCount < numThreads)
+    {
+        std::this_thread::sleep_for(1ms);
+    }
+    std::atomic_int highStarted { 0 };
+    std::atomic_int minHighStartedBeforeLow { numTasks };
+    std::vector<gusc::Threads::TaskQueue::TaskHandleWithFuture<void>> handles;
+    for (int i = 0; i < numTasks; ++i)
+    {
+        handles.push_back(queue.sendAsync<void>([&](){
+            const auto started = highStarted.load();
+            auto expected = minHighStartedBeforeLow.load();
+            while (started < expected && !minHighStartedBeforeLow.compare_exchange_weak(expected, started))
+            {}
+        }, Priority::Low));
+        handles.push_back(queue.sendAsync<void>([&](){
+            ++highStarted;
+            spinFor(10us);
+        }, Priority::High));
+    }
+    blockPromise.set_value();
+    for (auto& handle : handles)
+    {
+        handle.getValue();
+    }
+    // All the high priority tasks are taken before any low priority one, but the other threads might not have started theirs yet
+    EXPECT_GE(minHighStartedBeforeLow, numTasks - (numThreads - 1));
+}
+
 TEST_F(TaskQueueOnThisThreadTest, Test)
 {
     mock.setMock(&actualMock);
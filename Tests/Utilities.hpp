@@ -20,6 +20,14 @@
 
 using namespace std::chrono_literals;
 
+/// @brief keep the CPU busy for given time (a task that does actual work, as opposed to sleeping)
+inline void spinFor(std::chrono::microseconds duration)
+{
+    const auto end = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < end)
+    {}
+}
+
 inline std::string tidToStr(const std::thread::id& id)
 {
     std::ostringstream ss;
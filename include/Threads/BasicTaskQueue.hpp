@@ -0,0 +1,437 @@
+//
+//  BasicTaskQueue.hpp
+//  Threads
+//
+//  Created by Gusts Kaksis on 16/10/2026.
+//  Copyright © 2026 Gusts Kaksis. All rights reserved.
+//
+
+#ifndef GUSC_BASICTASKQUEUE_HPP
+#define GUSC_BASICTASKQUEUE_HPP
+
+#include "TaskQueue.hpp"
+#include "private/SpscQueue.hpp"
+#include <map>
+#include <type_traits>
+
+namespace gusc::Threads
+{
+
+/// @brief Producer policy - tasks can be sent from any number of threads at the same time
+struct MultiProducer {};
+/// @brief Producer policy - tasks are sent from one thread at a time (the queue thread sending tasks to itself counts as a producer too)
+struct SingleProducer {};
+/// @brief Delayed task policy - queue supports sendDelayed()
+struct WithDelayedTasks {};
+/// @brief Delayed task policy - queue does not support delayed tasks
+struct WithoutDelayedTasks {};
+/// @brief Sub-queue policy - queue supports createSubQueue()
+struct WithSubQueues {};
+/// @brief Sub-queue policy - queue does not support sub-queues
+struct WithoutSubQueues {};
+
+/// @brief Task ingress of a lean task queue
+template<typename TProducerPolicy>
+class LeanTaskIngress;
+
+/// @brief Lock-free ingress for many producers - intrusive MPSC list of pooled task nodes
+template<>
+class LeanTaskIngress<MultiProducer>
+{
+public:
+    LeanTaskIngress(std::pmr::memory_resource* initMemoryResource)
+        : memoryResource(initMemoryResource)
+    {}
+    ~LeanTaskIngress()
+    {
+        // Release tasks that were never executed
+        while (TaskNodePtr(queue.pop()))
+        {}
+    }
+
+    template<typename TCallable>
+    inline void push(TCallable&& newTask)
+    {
+        queue.push(TaskNode::create(memoryResource, std::forward<TCallable>(newTask)).release());
+    }
+
+    /// @brief execute the task at the front of the ingress
+    /// @return false if there are no tasks
+    inline bool executeNext()
+    {
+        auto node = TaskNodePtr(queue.pop());
+        if (!node)
+        {
+            return false;
+        }
+        node->execute();
+        return true;
+    }
+
+    inline bool empty() const noexcept
+    {
+        return queue.empty();
+    }
+
+private:
+    std::pmr::memory_resource* memoryResource;
+    IntrusiveMpscQueue<TaskNode> queue;
+};
+
+/// @brief Ingress for a single producer - ring segments with callable objects stored in place, no per-task allocation and no atomic read-modify-write
+template<>
+class LeanTaskIngress<SingleProducer>
+{
+public:
+    LeanTaskIngress(std::pmr::memory_resource* initMemoryResource)
+        : memoryResource(initMemoryResource)
+        , queue(initMemoryResource)
+    {}
+
+    template<typename TCallable>
+    inline void push(TCallable&& newTask)
+    {
+        queue.emplace(memoryResource, std::forward<TCallable>(newTask));
+    }
+
+    /// @brief execute the task at the front of the ingress
+    /// @return false if there are no tasks
+    inline bool executeNext()
+    {
+        return queue.consume([](InlineCallable<TaskNode::InlineSize>& callableObject){
+            callableObject();
+        });
+    }
+
+    inline bool empty() const noexcept
+    {
+        return queue.empty();
+    }
+
+private:
+    std::pmr::memory_resource* memoryResource;
+    SpscQueue<InlineCallable<TaskNode::InlineSize>> queue;
+};
+
+/// @brief Delayed task storage of a lean task queue
+template<typename TDelayedPolicy>
+class LeanDelayedTasks;
+
+template<>
+class LeanDelayedTasks<WithoutDelayedTasks>
+{
+public:
+    LeanDelayedTasks(std::pmr::memory_resource*)
+    {}
+
+    inline std::chrono::time_point<std::chrono::steady_clock> executeDue(std::chrono::time_point<std::chrono::steady_clock>)
+    {
+        return std::chrono::time_point<std::chrono::steady_clock>::max();
+    }
+
+    inline bool getIsChanged() const noexcept
+    {
+        return false;
+    }
+};
+
+template<>
+class LeanDelayedTasks<WithDelayedTasks>
+{
+public:
+    LeanDelayedTasks(std::pmr::memory_resource* initMemoryResource)
+        : memoryResource(initMemoryResource)
+        , tasks(initMemoryResource)
+    {}
+
+    template<typename TCallable>
+    inline void push(TCallable&& newTask, std::chrono::time_point<std::chrono::steady_clock> time)
+    {
+        auto node = TaskNode::create(memoryResource, std::forward<TCallable>(newTask));
+        const std::lock_guard lock(mutex);
+        tasks.emplace(time, std::move(node));
+        isChanged.store(true, std::memory_order_release);
+    }
+
+    /// @brief execute delayed tasks that are due (this is only called from the queue thread)
+    /// @return time of the next delayed task or time_point::max() if there are none
+    inline std::chrono::time_point<std::chrono::steady_clock> executeDue(std::chrono::time_point<std::chrono::steady_clock> timeNow)
+    {
+        if (!isChanged.exchange(false, std::memory_order_acq_rel) && timeNow < nextTime)
+        {
+            return nextTime;
+        }
+        while (true)
+        {
+            TaskNodePtr node;
+            {
+                const std::lock_guard lock(mutex);
+                if (tasks.empty() || tasks.begin()->first >= timeNow)
+                {
+                    nextTime = tasks.empty() ? std::chrono::time_point<std::chrono::steady_clock>::max() : tasks.begin()->first;
+                    return nextTime;
+                }
+                node = std::move(tasks.extract(tasks.begin()).mapped());
+            }
+            try
+            {
+                node->execute();
+            }
+            catch (...)
+            {
+                // We can't do nothing as nobody is listening, but we don't want the thread to explode
+            }
+        }
+    }
+
+    inline bool getIsChanged() const noexcept
+    {
+        return isChanged.load(std::memory_order_acquire);
+    }
+
+private:
+    std::pmr::memory_resource* memoryResource;
+    std::mutex mutex;
+    std::pmr::multimap<std::chrono::time_point<std::chrono::steady_clock>, TaskNodePtr> tasks;
+    std::atomic_bool isChanged { false };
+    std::chrono::time_point<std::chrono::steady_clock> nextTime { std::chrono::time_point<std::chrono::steady_clock>::max() };
+};
+
+/// @brief a serial task queue that only pays for the features selected by it's policies - there is no sub-queue support, no notify
+/// callback and no recursive mutexes, a single producer queue does not even use atomic read-modify-write operations to send a task
+/// @note use BasicTaskQueue alias to select the implementation for a set of policies
+template<typename TProducerPolicy, typename TDelayedPolicy>
+class LeanTaskQueue
+{
+public:
+    static_assert(std::is_same_v<TProducerPolicy, MultiProducer> || std::is_same_v<TProducerPolicy, SingleProducer>, "Unknown producer policy");
+    static_assert(std::is_same_v<TDelayedPolicy, WithDelayedTasks> || std::is_same_v<TDelayedPolicy, WithoutDelayedTasks>, "Unknown delayed task policy");
+
+    LeanTaskQueue(const std::string& initQueueName, const TaskQueueOptions& initOptions = {})
+        : maxBatchSize(std::max<std::size_t>(initOptions.maxBatchSize, 1))
+        , maxBatchDuration(initOptions.maxBatchDuration)
+        , idlePolicy(initOptions.idlePolicy)
+        , maxSpinDuration(initOptions.maxSpinDuration)
+        , timerPrecision(initOptions.timerPrecision)
+        , timerSpinDuration(initOptions.timerSpinDuration)
+        , ingress(initOptions.memoryResource)
+        , delayedTasks(initOptions.memoryResource)
+        , thread(initQueueName, std::bind(&LeanTaskQueue::runLoop, this, std::placeholders::_1))
+    {
+        thread.start();
+        threadId = thread.getId();
+    }
+    LeanTaskQueue()
+        : LeanTaskQueue("gusc::Threads::LeanTaskQueue")
+    {}
+    LeanTaskQueue(const LeanTaskQueue&) = delete;
+    LeanTaskQueue& operator=(const LeanTaskQueue&) = delete;
+    LeanTaskQueue(LeanTaskQueue&&) = delete;
+    LeanTaskQueue& operator=(LeanTaskQueue&&) = delete;
+    ~LeanTaskQueue()
+    {
+        acceptsTasks = false;
+        thread.stop();
+        eventCount.notifyAll();
+        // Thread is the last member, so it's joined before the rest of the queue is destroyed
+    }
+
+    /// @brief send a task that needs to be executed on this thread
+    /// @param newTask - any callable object that will be executed on this thread
+    template<typename TCallable>
+    inline void send(TCallable&& newTask)
+    {
+        if (getAcceptsTasks())
+        {
+            ingress.push(std::forward<TCallable>(newTask));
+            eventCount.notify();
+        }
+        else
+        {
+            throw std::runtime_error("Task queue is not accepting any tasks, the thread has been signaled for stopping");
+        }
+    }
+
+    /// @brief send a delayed task that needs to be executed on this thread (only available with WithDelayedTasks policy)
+    /// @param newTask - any callable object that will be executed on this thread
+    /// @note delayed tasks of a lean queue can not be cancelled
+    template<typename TCallable>
+    inline void sendDelayed(TCallable&& newTask, const std::chrono::milliseconds& timeout)
+    {
+        static_assert(std::is_same_v<TDelayedPolicy, WithDelayedTasks>, "Task queue was specialized without delayed task support");
+        if (getAcceptsTasks())
+        {
+            delayedTasks.push(std::forward<TCallable>(newTask), std::chrono::steady_clock::now() + timeout);
+            eventCount.notify();
+        }
+        else
+        {
+            throw std::runtime_error("Task queue is not accepting any tasks, the thread has been signaled for stopping");
+        }
+    }
+
+    /// @brief send an asynchronous task that returns value and needs to be executed on this thread
+    /// @param newTask - any callable object that will be executed on this thread and it must return a value of type specified in TReturn (signature: TReturn(void))
+    /// @return a future of the task result
+    template<typename TReturn, typename TCallable>
+    inline std::future<TReturn> sendAsync(TCallable&& newTask)
+    {
+        std::promise<TReturn> promise;
+        auto future = promise.get_future();
+        auto task = [callableObject = std::forward<TCallable>(newTask), promise = std::move(promise)]() mutable {
+            try
+            {
+                if constexpr (std::is_void_v<TReturn>)
+                {
+                    callableObject();
+                    promise.set_value();
+                }
+                else
+                {
+                    promise.set_value(callableObject());
+                }
+            }
+            catch (...)
+            {
+                promise.set_exception(std::current_exception());
+            }
+        };
+        if (getIsSameThread())
+        {
+            // If we are on the same thread excute task immediatelly to prevent a deadlock
+            task();
+        }
+        else
+        {
+            send(std::move(task));
+        }
+        return future;
+    }
+
+    /// @brief send a synchronous task that returns value and needs to be executed on this thread (calling thread is blocked until task returns)
+    /// @param newTask - any callable object that will be executed on this thread and it must return a value of type specified in TReturn (signature: TReturn(void))
+    template<typename TReturn, typename TCallable>
+    inline TReturn sendSync(TCallable&& newTask)
+    {
+        if (!getAcceptsTasks())
+        {
+            throw std::runtime_error("Can not place a blocking task if the thread is not started");
+        }
+        return sendAsync<TReturn>(std::forward<TCallable>(newTask)).get();
+    }
+
+    /// @brief send a task that needs to be executed on this thread and wait for it's completion
+    /// @param newTask - any callable object that will be executed on this thread
+    template<typename TCallable>
+    inline void sendWait(TCallable&& newTask)
+    {
+        sendSync<void>(std::forward<TCallable>(newTask));
+    }
+
+    /// @brief Check if we are on caller is on the same thread as the task queue
+    inline bool getIsSameThread() const noexcept
+    {
+        return threadId == std::this_thread::get_id();
+    }
+
+    /// @brief Get if task queue accepts new tasks
+    inline bool getAcceptsTasks() const noexcept
+    {
+        return acceptsTasks;
+    }
+
+private:
+    std::size_t maxBatchSize;
+    std::chrono::microseconds maxBatchDuration;
+    IdlePolicy idlePolicy;
+    std::chrono::microseconds maxSpinDuration;
+    TimerPrecision timerPrecision;
+    std::chrono::microseconds timerSpinDuration;
+    std::thread::id threadId;
+    std::atomic_bool acceptsTasks { true };
+    EventCount eventCount;
+    LeanTaskIngress<TProducerPolicy> ingress;
+    LeanDelayedTasks<TDelayedPolicy> delayedTasks;
+    Thread thread;
+
+    inline void runLoop(const Thread::StopToken& stopToken)
+    {
+        IdleState idleState { idlePolicy, maxSpinDuration, timerPrecision, timerSpinDuration };
+        while (!stopToken.getIsStopping())
+        {
+            const auto timeNow = std::chrono::steady_clock::now();
+            const auto nextTaskTime = delayedTasks.executeDue(timeNow);
+            if (executeBatch(timeNow + maxBatchDuration))
+            {
+                continue;
+            }
+            // Announce that we are about to wait and check once more, so that a task pushed in the meantime is not missed
+            const auto waitKey = eventCount.prepareWait();
+            if (stopToken.getIsStopping() || !getAcceptsTasks() || !ingress.empty() || delayedTasks.getIsChanged())
+            {
+                eventCount.cancelWait();
+            }
+            else
+            {
+                idleState.wait(eventCount, waitKey, timeNow, nextTaskTime);
+            }
+        }
+        acceptsTasks = false;
+        /// @note Delayed tasks are implicitly canceled by this point as their deadlines hadn't arrived
+        // Process any leftover tasks
+        while (executeBatch(std::chrono::time_point<std::chrono::steady_clock>::max()))
+        {}
+    }
+
+    /// @brief execute tasks back to back until there are none left or the batch budget is spent
+    /// @return true if at least one task was executed
+    inline bool executeBatch(std::chrono::time_point<std::chrono::steady_clock> deadline)
+    {
+        std::size_t executedCount { 0 };
+        while (executedCount < maxBatchSize)
+        {
+            try
+            {
+                if (!ingress.executeNext())
+                {
+                    break;
+                }
+            }
+            catch (...)
+            {
+                // We can't do nothing as nobody is listening, but we don't want the thread to explode
+            }
+            // Reading the clock costs about as much as a tiny task, so we only do it every few tasks
+            if ((++executedCount % 8) == 0 && std::chrono::steady_clock::now() >= deadline)
+            {
+                break;
+            }
+        }
+        return executedCount != 0;
+    }
+};
+
+/// @brief Selects task queue implementation for a set of policies
+template<typename TProducerPolicy, typename TDelayedPolicy, typename TSubQueuePolicy>
+struct BasicTaskQueueSelector
+{
+    static_assert(std::is_same_v<TSubQueuePolicy, WithoutSubQueues>, "Unknown sub-queue policy");
+    using Type = LeanTaskQueue<TProducerPolicy, TDelayedPolicy>;
+};
+
+/// @brief Sub-queues need the full task queue machinery (task handles, cancellation, sub-queue scheduling)
+template<typename TProducerPolicy, typename TDelayedPolicy>
+struct BasicTaskQueueSelector<TProducerPolicy, TDelayedPolicy, WithSubQueues>
+{
+    using Type = SerialTaskQueue;
+};
+
+/// @brief Serial task queue specialized at compile time for the features it needs
+/// BasicTaskQueue<> (multiple producers, delayed tasks and sub-queues) is SerialTaskQueue, configurations without sub-queues
+/// compile down to LeanTaskQueue
+template<typename TProducerPolicy = MultiProducer, typename TDelayedPolicy = WithDelayedTasks, typename TSubQueuePolicy = WithSubQueues>
+using BasicTaskQueue = typename BasicTaskQueueSelector<TProducerPolicy, TDelayedPolicy, TSubQueuePolicy>::Type;
+
+} // namespace gusc::Threads
+
+#endif /* GUSC_BASICTASKQUEUE_HPP */
@@ -0,0 +1,161 @@
+//
+//  SlabMemoryResource.hpp
+//  Threads
+//
+//  Created by Gusts Kaksis on 16/10/2026.
+//  Copyright © 2026 Gusts Kaksis. All rights reserved.
+//
+
+#ifndef GUSC_SLABMEMORYRESOURCE_HPP
+#define GUSC_SLABMEMORYRESOURCE_HPP
+
+#include "private/BlockPool.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+
+namespace gusc::Threads
+{
+
+/// @brief Size-class slab memory resource with per-thread caches
+/// Allocations up to MaxBlockSize bytes are served from process-wide block pools (one per size class) where each thread keeps it's own
+/// cache of free blocks, so memory allocated on a producer thread and released on a consumer thread does not go through the global allocator.
+/// Larger or over-aligned allocations are passed to the upstream (new/delete) resource.
+/// @note all instances share the same pools, blocks are never returned to the system
+class SlabMemoryResource final : public std::pmr::memory_resource
+{
+public:
+    static constexpr std::size_t MaxBlockSize { 1024 };
+    static constexpr std::size_t MaxBlockAlignment { alignof(std::max_align_t) };
+
+    /// @brief Allocation counters
+    struct Statistics
+    {
+        /// @brief number of blocks size-class pools requested from the system (this does not grow in steady state)
+        std::size_t systemAllocationCount { 0 };
+        /// @brief number of bytes size-class pools requested from the system
+        std::size_t systemAllocationSize { 0 };
+        /// @brief number of allocations that were too big for size-class pools and were passed to upstream resource
+        std::size_t upstreamAllocationCount { 0 };
+    };
+
+    /// @brief get process-wide default instance
+    static inline SlabMemoryResource* getDefault() noexcept
+    {
+        static SlabMemoryResource resource;
+        return &resource;
+    }
+
+    /// @brief hand over blocks freed on calling thread to other threads
+    /// @note task queues call this before going idle, so that blocks released by a consumer are immediately available to producers
+    static inline void flushThreadCache() noexcept
+    {
+        for (const auto& sizeClass : getSizeClasses())
+        {
+            sizeClass.flushThreadCache();
+        }
+    }
+
+    /// @brief get allocation counters of all the size-class pools
+    inline Statistics getStatistics() const noexcept
+    {
+        Statistics statistics;
+        for (const auto& sizeClass : getSizeClasses())
+        {
+            const auto count = sizeClass.getSystemAllocationCount();
+            statistics.systemAllocationCount += count;
+            statistics.systemAllocationSize += count * sizeClass.size;
+        }
+        statistics.upstreamAllocationCount = upstreamAllocationCount.load(std::memory_order_relaxed);
+        return statistics;
+    }
+
+protected:
+    inline void* do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        if (auto sizeClass = findSizeClass(bytes, alignment))
+        {
+            return sizeClass->allocate();
+        }
+        upstreamAllocationCount.fetch_add(1, std::memory_order_relaxed);
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    inline void do_deallocate(void* ptr, std::size_t bytes, std::size_t alignment) override
+    {
+        if (auto sizeClass = findSizeClass(bytes, alignment))
+        {
+            sizeClass->deallocate(ptr);
+        }
+        else
+        {
+            std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+        }
+    }
+
+    inline bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        // Blocks are interchangeable between instances as they all share the same pools
+        return dynamic_cast<const SlabMemoryResource*>(&other) != nullptr;
+    }
+
+private:
+    struct SizeClass
+    {
+        std::size_t size;
+        void* (*allocate)();
+        void (*deallocate)(void*) noexcept;
+        void (*flushThreadCache)() noexcept;
+        std::size_t (*getSystemAllocationCount)() noexcept;
+    };
+
+    template<std::size_t BlockSize>
+    static constexpr SizeClass makeSizeClass() noexcept
+    {
+        using Pool = BlockPool<BlockSize, MaxBlockAlignment>;
+        return { BlockSize, &Pool::allocate, &Pool::deallocate, &Pool::flushThreadCache, &Pool::getSystemAllocationCount };
+    }
+
+    std::atomic<std::size_t> upstreamAllocationCount { 0 };
+
+    static inline const std::array<SizeClass, 13>& getSizeClasses() noexcept
+    {
+        static constexpr std::array<SizeClass, 13> sizeClasses {
+            makeSizeClass<16>(),
+            makeSizeClass<32>(),
+            makeSizeClass<48>(),
+            makeSizeClass<64>(),
+            makeSizeClass<80>(),
+            makeSizeClass<96>(),
+            makeSizeClass<128>(),
+            makeSizeClass<192>(),
+            makeSizeClass<256>(),
+            makeSizeClass<384>(),
+            makeSizeClass<512>(),
+            makeSizeClass<768>(),
+            makeSizeClass<MaxBlockSize>()
+        };
+        return sizeClasses;
+    }
+
+    static inline const SizeClass* findSizeClass(std::size_t bytes, std::size_t alignment) noexcept
+    {
+        if (alignment > MaxBlockAlignment)
+        {
+            return nullptr;
+        }
+        for (const auto& sizeClass : getSizeClasses())
+        {
+            if (bytes <= sizeClass.size)
+            {
+                return &sizeClass;
+            }
+        }
+        return nullptr;
+    }
+};
+
+} // namespace gusc::Threads
+
+#endif /* GUSC_SLABMEMORYRESOURCE_HPP */
@@ -11,17 +11,126 @@
 
 #include "Thread.hpp"
 #include "ThreadPool.hpp"
+#include "SlabMemoryResource.hpp"
+#include "TimerService.hpp"
+#include "private/IdleState.hpp"
+#include "private/IntrusiveMpscQueue.hpp"
+#include "private/TaskNode.hpp"
+#include "private/TimingWheel.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <set>
+#include <type_traits>
+#include <limits>
+#include <list>
+#include <map>
 #include <mutex>
+#include <unordered_map>
 #include <utility>
 #include <future>
-#include <queue>
+#include <initializer_list>
+#include <memory_resource>
+#include <vector>
 
 namespace gusc
 {
 namespace Threads
 {
 
+/// @brief Order in which queue threads take tasks that were sent with a deadline
+enum class SchedulingMode
+{
+    /// @brief tasks sent with a deadline are queued together with tasks of normal priority in the order they were sent
+    Priority,
+    /// @brief tasks sent with a deadline are taken before any other tasks, earliest deadline first (ties are taken in the order they were sent)
+    EarliestDeadlineFirst
+};
+
+/// @brief What tasks of the main queue and sub-queues are charged with when they share the queue's time (see TaskQueue::createSubQueue())
+enum class FairShareCost
+{
+    /// @brief tasks are charged with the average execution time of their queue, so busy sub-queues get execution time in proportion to their weights
+    ExecutionTime,
+    /// @brief every task is charged the same, so busy sub-queues execute tasks in proportion to their weights no matter how long the tasks take
+    TaskCount
+};
+
+/// @brief What happens when a task is sent with a key of a task that's still waiting in the queue
+enum class CoalescingPolicy
+{
+    /// @brief new task replaces the waiting one, but keeps it's position in the queue
+    Replace,
+    /// @brief new task is dropped and the waiting one is executed
+    Drop
+};
+
+/// @brief Data structure that keeps delayed tasks until they are due
+enum class TimerBackend
+{
+    /// @brief ordered tree - O(log n) insert, delayed tasks are moved to the task queue in the exact order of their time
+    OrderedSet,
+    /// @brief hierarchical timing wheel - O(1) insert and amortized O(1) expiry, delayed tasks are moved to the task queue with the
+    /// granularity of TaskQueueOptions::timerResolution (never early, tasks due within the same tick are moved in the order they were sent)
+    TimingWheel
+};
+
+/// @brief How a periodic task is scheduled after it has been executed
+enum class PeriodicPolicy
+{
+    /// @brief task is executed at fixed points in time (start + n * period), points that have passed while the task was waiting or running are skipped
+    FixedRate,
+    /// @brief task is executed at fixed points in time (start + n * period), points that have passed are made up for by executing the task back to back
+    FixedRateCatchUp,
+    /// @brief task is executed a period after the previous execution has finished
+    FixedDelay
+};
+
+/// @brief Task queue construction options
+struct TaskQueueOptions
+{
+    /// @brief memory resource used for task queue internals (task nodes, captures that don't fit inline, delayed tasks, etc.)
+    std::pmr::memory_resource* memoryResource { SlabMemoryResource::getDefault() };
+    /// @brief maximum number of tasks a thread executes back to back before it looks at delayed tasks again
+    std::size_t maxBatchSize { 64 };
+    /// @brief maximum time a thread executes tasks back to back before it looks at delayed tasks again
+    std::chrono::microseconds maxBatchDuration { 1000 };
+    /// @brief what queue threads do when they run out of tasks
+    IdlePolicy idlePolicy { IdlePolicy::Blocking };
+    /// @brief maximum time queue threads spin before going to sleep (used with IdlePolicy::Spin and IdlePolicy::Adaptive)
+    std::chrono::microseconds maxSpinDuration { 50 };
+    /// @brief maximum time tasks of a lower priority are passed over in favour of tasks of a higher priority before they are taken ahead of them
+    /// (std::chrono::microseconds::max() disables aging, so lower priority tasks only run when there are no higher priority tasks)
+    std::chrono::microseconds priorityAgingInterval { 10000 };
+    /// @brief order in which tasks sent with a deadline are taken
+    SchedulingMode schedulingMode { SchedulingMode::Priority };
+    /// @brief what tasks of the queue and it's sub-queues are charged with when they share the queue's time
+    FairShareCost fairShareCost { FairShareCost::ExecutionTime };
+    /// @brief maximum number of tasks waiting in the queue (0 - unlimited), producers are blocked while the queue is full
+    std::size_t capacity { 0 };
+    /// @brief maximum estimated size of tasks waiting in the queue in bytes (0 - unlimited), producers are blocked while the queue is full
+    std::size_t capacitySize { 0 };
+    /// @brief number of tasks waiting in the queue at which sheddable tasks of low priority are shed (0 - disabled), sheddable tasks of normal
+    /// priority are shed at twice the number and sheddable tasks of high priority at four times the number
+    std::size_t loadSheddingDepth { 0 };
+    /// @brief time tasks have waited in the queue at which sheddable tasks of low priority are shed (0 - disabled), sheddable tasks of normal
+    /// priority are shed at twice the time and sheddable tasks of high priority at four times the time
+    std::chrono::microseconds loadSheddingAge { 0 };
+    /// @brief time slice an idle task gets before it's asked to yield (see TaskQueue::sendIdle())
+    std::chrono::microseconds idleTimeSlice { 1000 };
+    /// @brief data structure that keeps delayed tasks until they are due
+    TimerBackend timerBackend { TimerBackend::OrderedSet };
+    /// @brief length of a timing wheel tick (only used with TimerBackend::TimingWheel)
+    std::chrono::microseconds timerResolution { 1000 };
+    /// @brief timer service that moves delayed tasks to the queue once they are due (nullptr - queue threads move them on their own), use
+    /// TimerService::getDefault() to share a single timer thread among all the queues of the process
+    TimerService* timerService { nullptr };
+    /// @brief how precisely the queue thread wakes up for it's next delayed task (only used by serial queues)
+    TimerPrecision timerPrecision { TimerPrecision::Default };
+    /// @brief time the queue thread spins before a delayed task is due instead of sleeping (only used with TimerPrecision::High)
+    std::chrono::microseconds timerSpinDuration { 50 };
+};
+
 /// @brief Class representing a base task queue
 class TaskQueue
 {
@@ -91,8 +200,73 @@ public:
         std::future<void> future;
     };
     
-    TaskQueue(const std::function<void(void)>& initQueueNotifyCallback)
-        : queueNotifyCallback(initQueueNotifyCallback)
+    /// @brief Time slice of an idle task, the task should return once it's asked to yield (see TaskQueue::sendIdle())
+    class IdleDeadline
+    {
+    public:
+        IdleDeadline(const TaskQueue& initQueue, std::chrono::time_point<std::chrono::steady_clock> initDeadline)
+            : queue(initQueue)
+            , deadline(initDeadline)
+        {}
+        /// @brief get the time at which the time slice ends
+        inline std::chrono::time_point<std::chrono::steady_clock> getDeadline() const noexcept
+        {
+            return deadline;
+        }
+        /// @brief check if the task should return, because the time slice has ended or new tasks have been sent to the queue
+        inline bool getShouldYield() const noexcept
+        {
+            const auto timeNow = std::chrono::steady_clock::now();
+            return timeNow >= deadline || queue.getHasNewTasks(timeNow);
+        }
+    private:
+        friend class TaskQueue;
+        const TaskQueue& queue;
+        std::chrono::time_point<std::chrono::steady_clock> deadline;
+        /// @brief set if the task has more work to do and has to be executed again
+        bool isContinued { false };
+    };
+    
+    /// @brief Task priorities
+    /// Tasks of the same priority are executed in the order they were sent, a thread takes tasks of a higher priority first, but a task
+    /// that's already been taken (i.e. the rest of the batch that's being executed) is not preempted
+    enum class Priority : std::size_t
+    {
+        High,
+        Normal,
+        Low
+    };
+    static constexpr std::size_t PriorityCount { 3 };
+
+    /// @brief task queue counters
+    struct Statistics
+    {
+        /// @brief number of tasks executed from this queue (tasks of sub-queues are counted by the sub-queues themselves)
+        std::size_t executedCount { 0 };
+        /// @brief total time spent executing tasks of this queue
+        std::chrono::nanoseconds executionTime { 0 };
+        /// @brief total time tasks have waited in this queue before they were taken for execution (only measured for sub-queues)
+        std::chrono::nanoseconds totalWaitTime { 0 };
+        /// @brief longest time a task has waited in this queue (only measured for sub-queues)
+        std::chrono::nanoseconds maxWaitTime { 0 };
+        /// @brief number of tasks that were sent with a deadline, but finished after it
+        std::size_t deadlineMissCount { 0 };
+        /// @brief number of tasks that were dropped because they expired before they were started
+        std::size_t expiredCount { 0 };
+        /// @brief number of sheddable tasks that were dropped from the queue because it was overloaded
+        std::size_t shedCount { 0 };
+        /// @brief number of sheddable tasks that were rejected when sent because the queue was overloaded
+        std::size_t rejectedCount { 0 };
+        /// @brief number of tasks waiting in the queue (only counted if the queue has a capacity or load shedding)
+        std::size_t pendingCount { 0 };
+        /// @brief how long the tasks taken from the queue most recently have waited (only measured if the queue has load shedding by age)
+        std::chrono::nanoseconds queueDelay { 0 };
+    };
+
+    TaskQueue(const std::function<void(void)>& initQueueNotifyCallback, const TaskQueueOptions& initOptions = {})
+        : TaskQueue(initQueueNotifyCallback ? [initQueueNotifyCallback](std::size_t){
+            initQueueNotifyCallback();
+        } : std::function<void(std::size_t)>{}, initOptions)
     {}
     TaskQueue(const TaskQueue&) = delete;
     TaskQueue& operator=(const TaskQueue&) = delete;
@@ -101,20 +275,187 @@ public:
     virtual ~TaskQueue()
     {
         setAcceptsTasks(false);
+        // Waits for the timer service if it's moving our delayed tasks right now
+        serviceTimer.reset();
+        {
+            const std::lock_guard lock(delayedTaskOwner->mutex);
+            // Delayed tasks that are cancelled from now on don't reach this queue any more
+            delayedTaskOwner->queue = nullptr;
+            clearDelayedTasks();
+        }
         releaseSubQueues();
-        notifyQueueChange();
+        if (parentLink)
+        {
+            // Let the parent queue forget this sub-queue, a link that's still in parent's ready list is skipped once it's popped
+            const std::lock_guard lock(parentLink->parentList->mutex);
+            parentLink->parentList->queues.erase(parentPosition);
+        }
+        // Release tasks that were never picked up
+        clearTasks();
     }
 
     /// @brief send a task that needs to be executed on this thread
     /// @param newTask - any callable object that will be executed on this thread
+    /// @param priority - priority of the task
+    /// @note if the queue has a capacity and it's full the calling thread is blocked until there is room for the task (tasks sent from
+    /// the queue thread itself are never blocked, as that would deadlock)
+    template<typename TCallable>
+    inline void send(TCallable&& newTask, Priority priority = Priority::Normal)
+    {
+        sendNode(TaskNode::create(memoryResource, std::forward<TCallable>(newTask)), priority, std::chrono::time_point<std::chrono::steady_clock>::max());
+    }
+    template<typename TCallable>
+    inline void send(TCallable& newTask, Priority priority = Priority::Normal)
+    {
+        // Enforce reference to create a copy
+        TCallable tmp = newTask;
+        send(std::move(tmp), priority);
+    }
+
+    /// @brief send a task if there is room for it in the queue (see send())
+    /// @param newTask - any callable object that will be executed on this thread
+    /// @param priority - priority of the task
+    /// @return false if the queue is full
+    template<typename TCallable>
+    inline bool trySend(TCallable&& newTask, Priority priority = Priority::Normal)
+    {
+        return sendNode(TaskNode::create(memoryResource, std::forward<TCallable>(newTask)), priority, std::chrono::time_point<std::chrono::steady_clock>::min());
+    }
+    template<typename TCallable>
+    inline bool trySend(TCallable& newTask, Priority priority = Priority::Normal)
+    {
+        // Enforce reference to create a copy
+        TCallable tmp = newTask;
+        return trySend(std::move(tmp), priority);
+    }
+
+    /// @brief send a task waiting for a room in the queue for no longer than given time (see send())
+    /// @param newTask - any callable object that will be executed on this thread
+    /// @param timeout - maximum time to wait while the queue is full
+    /// @param priority - priority of the task
+    /// @return false if the queue was still full when timeout expired
+    template<typename TCallable>
+    inline bool trySendFor(TCallable&& newTask, const std::chrono::milliseconds& timeout, Priority priority = Priority::Normal)
+    {
+        return sendNode(TaskNode::create(memoryResource, std::forward<TCallable>(newTask)), priority, std::chrono::steady_clock::now() + timeout);
+    }
+    template<typename TCallable>
+    inline bool trySendFor(TCallable& newTask, const std::chrono::milliseconds& timeout, Priority priority = Priority::Normal)
+    {
+        // Enforce reference to create a copy
+        TCallable tmp = newTask;
+        return trySendFor(std::move(tmp), timeout, priority);
+    }
+
+    /// @brief send a task that may be dropped if the queue is overloaded (see TaskQueueOptions::loadSheddingDepth and loadSheddingAge)
+    /// @param newTask - any callable object that will be executed on this thread
+    /// @param onCancel - any callable object that is called instead of the task if the task is shed or cancelled (it's called on the thread
+    /// that drops the task - the calling thread if the task is rejected right away or the queue thread if it's dropped from the queue)
+    /// @param priority - priority of the task, sheddable tasks of lower priority are shed first
+    /// @return false if the task was rejected because the queue is overloaded
+    template<typename TCallable, typename TCancelCallable>
+    inline bool sendSheddable(TCallable&& newTask, TCancelCallable&& onCancel, Priority priority = Priority::Normal)
+    {
+        if (!getAcceptsTasks())
+        {
+            throw std::runtime_error("Task queue is not accepting any tasks, the thread has been signaled for stopping");
+        }
+        if (getIsShed(priority))
+        {
+            rejectedCount.fetch_add(1, std::memory_order_relaxed);
+            onCancel();
+            return false;
+        }
+        using TTask = TaskWithCancelCallback<std::decay_t<TCallable>, std::decay_t<TCancelCallable>>;
+        auto task = std::allocate_shared<TTask>(std::pmr::polymorphic_allocator<Task>(memoryResource), std::forward<TCallable>(newTask), std::forward<TCancelCallable>(onCancel));
+        auto node = createTaskNode(std::move(task));
+        node->setIsSheddable(true);
+        return sendNode(std::move(node), priority, std::chrono::time_point<std::chrono::steady_clock>::max());
+    }
+
+    /// @brief send a task that's coalesced with a task of the same key if one is still waiting in the queue
+    /// @param key - key identifying the task (use std::hash to turn other types of keys into one)
+    /// @param newTask - any callable object that will be executed on this thread
+    /// @param policy - whether the new task replaces the waiting one or is dropped
+    /// @param priority - priority of the task (a coalesced task keeps the priority of the waiting one)
+    /// @return false if the task was coalesced with a waiting one
+    template<typename TCallable>
+    inline bool sendCoalesced(std::size_t key, TCallable&& newTask, CoalescingPolicy policy = CoalescingPolicy::Replace, Priority priority = Priority::Normal)
+    {
+        if (!getAcceptsTasks())
+        {
+            throw std::runtime_error("Task queue is not accepting any tasks, the thread has been signaled for stopping");
+        }
+        std::call_once(coalescedTasksFlag, [this](){
+            coalescedTasks = std::allocate_shared<CoalescedTaskMap>(std::pmr::polymorphic_allocator<CoalescedTaskMap>(memoryResource), memoryResource);
+        });
+        auto node = TaskNode::create(memoryResource, std::forward<TCallable>(newTask));
+        {
+            const std::lock_guard lock(coalescedTasks->mutex);
+            auto it = coalescedTasks->tasks.find(key);
+            if (it != coalescedTasks->tasks.end())
+            {
+                if (policy == CoalescingPolicy::Replace)
+                {
+                    // Previous task is released once we've unlocked the mutex
+                    std::swap(it->second, node);
+                }
+                return false;
+            }
+            coalescedTasks->tasks.emplace(key, std::move(node));
+        }
+        // The node in the queue only refers to the map entry, so that the task can be replaced while it's waiting
+        sendNode(TaskNode::create(memoryResource, CoalescedTask { coalescedTasks, key }), priority, std::chrono::time_point<std::chrono::steady_clock>::max());
+        return true;
+    }
+    
+    /// @brief send a delayed task that needs to be executed on this thread
+    /// @param newTask - any callable object that will be executed on this thread
+    /// @param priority - priority the task gets once it's timeout has expired
+    /// @return a TaskHandle object which allows you to cancel delayed task before it's timeout has expired
+    /// @note once the task is moved from delayed queue to task queue it's TaskHandle object be expired and won't be cancellable any more,
+    /// a task that's cancelled before that is removed from the delayed queue right away, which releases the callable object
+    template<typename TCallable>
+    inline TaskHandle sendDelayed(TCallable&& newTask, const std::chrono::milliseconds& timeout, Priority priority = Priority::Normal)
+    {
+        return sendDelayed(std::forward<TCallable>(newTask), timeout, std::chrono::milliseconds::zero(), priority);
+    }
+    template<typename TCallable>
+    inline TaskHandle sendDelayed(TCallable& newTask, const std::chrono::milliseconds& timeout, Priority priority = Priority::Normal)
+    {
+        // Enforce reference to create a copy
+        TCallable tmp = newTask;
+        return sendDelayed(std::move(tmp), timeout, priority);
+    }
+
+    /// @brief send a delayed task that may be moved to the task queue up to tolerance later than it's timeout, so that the queue thread
+    /// can wake up once for many delayed tasks which windows overlap
+    /// @param newTask - any callable object that will be executed on this thread
+    /// @param timeout - earliest time after which the task is moved to the task queue
+    /// @param tolerance - time after the timeout by which the task has to be moved to the task queue
+    /// @param priority - priority the task gets once it's timeout has expired
+    /// @return a TaskHandle object which allows you to cancel delayed task before it's moved to the task queue
+    /// @note the queue wakes up at the latest time of the earliest delayed task and moves all the tasks which timeout has expired by then
     template<typename TCallable>
-    inline void send(TCallable&& newTask)
+    inline TaskHandle sendDelayed(TCallable&& newTask, const std::chrono::milliseconds& timeout, const std::chrono::milliseconds& tolerance, Priority priority = Priority::Normal)
     {
         if (getAcceptsTasks())
         {
             const std::lock_guard lock(taskQueueMutex);
-            taskQueue.emplace(std::make_shared<TaskWithCallable<TCallable>>(std::forward<TCallable>(newTask)));
-            notifyQueueChange();
+            auto time = std::chrono::steady_clock::now() + timeout;
+            auto task = std::allocate_shared<DelayedTaskWithCallable<TCallable>>(std::pmr::polymorphic_allocator<Task>(memoryResource), std::forward<TCallable>(newTask), delayedTaskOwner, priority);
+            TaskHandle handle { task };
+            time = addDelayedTask(std::move(task), time, std::max(tolerance, std::chrono::milliseconds::zero()));
+            if (serviceTimer)
+            {
+                serviceTimer->schedule(time);
+            }
+            else
+            {
+                registerSubQueueTimer(time);
+                notifyQueueChange(0);
+            }
+            return handle;
         }
         else
         {
@@ -122,28 +463,95 @@ public:
         }
     }
     template<typename TCallable>
-    inline void send(TCallable& newTask)
+    inline TaskHandle sendDelayed(TCallable& newTask, const std::chrono::milliseconds& timeout, const std::chrono::milliseconds& tolerance, Priority priority = Priority::Normal)
     {
         // Enforce reference to create a copy
         TCallable tmp = newTask;
-        send(std::move(tmp));
+        return sendDelayed(std::move(tmp), timeout, tolerance, priority);
+    }
+
+    /// @brief send a task that's executed once no other task with the same key has been sent for given time
+    /// @param key - key identifying the task (keys are shared with throttle(), use std::hash to turn other types of keys into one)
+    /// @param delay - time without new tasks of the same key after which the last one is executed
+    /// @param newTask - any callable object that will be executed on this thread, it replaces the task that's waiting
+    /// @param priority - priority the task gets once it's delay has expired
+    /// @note every key has a single timer that's moved in place, so a burst of tasks does not pile up delayed tasks
+    template<typename TCallable>
+    inline void debounce(std::size_t key, const std::chrono::milliseconds& delay, TCallable&& newTask, Priority priority = Priority::Normal)
+    {
+        if (!getAcceptsTasks())
+        {
+            throw std::runtime_error("Task queue is not accepting any tasks, the thread has been signaled for stopping");
+        }
+        auto node = TaskNode::create(memoryResource, std::forward<TCallable>(newTask));
+        const std::lock_guard lock(taskQueueMutex);
+        const auto time = std::chrono::steady_clock::now() + delay;
+        auto it = keyedTimers.find(key);
+        if (it != keyedTimers.end())
+        {
+            // Previous task is released once we've unlocked the mutex
+            std::swap(it->second.task, node);
+            it->second.priority = priority;
+            moveKeyedTimer(it->second, time);
+        }
+        else
+        {
+            addKeyedTimer(key, time, { std::move(node), priority, std::chrono::steady_clock::duration::zero() });
+        }
+    }
+
+    /// @brief send a task that's executed right away, unless a task with the same key has been executed less than given interval ago,
+    /// in which case it's executed once the interval has passed (if more tasks are sent in the meantime only the last one is executed)
+    /// @param key - key identifying the task (keys are shared with debounce(), use std::hash to turn other types of keys into one)
+    /// @param interval - minimum time between executions of tasks with the same key
+    /// @param newTask - any callable object that will be executed on this thread, it replaces the task that's waiting
+    /// @param priority - priority of the task
+    template<typename TCallable>
+    inline void throttle(std::size_t key, const std::chrono::milliseconds& interval, TCallable&& newTask, Priority priority = Priority::Normal)
+    {
+        if (!getAcceptsTasks())
+        {
+            throw std::runtime_error("Task queue is not accepting any tasks, the thread has been signaled for stopping");
+        }
+        auto node = TaskNode::create(memoryResource, std::forward<TCallable>(newTask));
+        const std::lock_guard lock(taskQueueMutex);
+        auto it = keyedTimers.find(key);
+        if (it != keyedTimers.end())
+        {
+            // Task waits for the end of the interval, previous task is released once we've unlocked the mutex
+            std::swap(it->second.task, node);
+            it->second.priority = priority;
+            return;
+        }
+        // The timer only marks the end of the interval, the task itself goes to the queue right away
+        const auto timerInterval = std::max<std::chrono::steady_clock::duration>(interval, std::chrono::steady_clock::duration(1));
+        addKeyedTimer(key, std::chrono::steady_clock::now() + timerInterval, { nullptr, priority, timerInterval });
+        addCapacity(1, node->getSize());
+        pushTask(std::move(node), priority);
+        notifyQueueChange();
     }
     
-    /// @brief send a delayed task that needs to be executed on this thread
-    /// @param newTask - any callable object that will be executed on this thread
-    /// @return a TaskHandle object which allows you to cancel delayed task before it's timeout has expired
-    /// @note once the task is moved from delayed queue to task queue it's TaskHandle object be expired and won't be cancellable any more
+    /// @brief send a task that's executed periodically on this thread until it's cancelled
+    /// @param newTask - any callable object that will be executed on this thread, the same object is executed every time
+    /// @param period - time between executions of the task (at least 1 ms), the first execution is a period after the task was sent
+    /// @param policy - how the task is scheduled when it's executed late or runs longer than the period
+    /// @param priority - priority of the task
+    /// @return a TaskHandle object which allows you to cancel the task (it's expired once the cancelled task has been released by the queue)
+    /// @note times are kept on an absolute schedule, so they don't drift, and only a single execution of the task is queued at a time
     template<typename TCallable>
-    inline TaskHandle sendDelayed(TCallable&& newTask, const std::chrono::milliseconds& timeout)
+    inline TaskHandle sendPeriodic(TCallable&& newTask, const std::chrono::milliseconds& period, PeriodicPolicy policy = PeriodicPolicy::FixedRate, Priority priority = Priority::Normal)
     {
         if (getAcceptsTasks())
         {
             const std::lock_guard lock(taskQueueMutex);
-            auto time = std::chrono::steady_clock::now() + timeout;
-            auto task = std::make_shared<TaskWithCallable<TCallable>>(std::forward<TCallable>(newTask));
+            const auto interval = std::max(period, std::chrono::milliseconds(1));
+            auto task = std::allocate_shared<PeriodicTaskWithCallable<TCallable>>(std::pmr::polymorphic_allocator<Task>(memoryResource), std::forward<TCallable>(newTask), interval, policy, priority);
             TaskHandle handle { task };
-            delayedQueue.emplace(std::make_unique<DelayedTaskWrapper>(time, std::move(task)));
-            notifyQueueChange();
+            task->time = std::chrono::steady_clock::now() + interval;
+            auto& ref = *task;
+            ref.position = periodicQueue.emplace(ref.time, std::move(task));
+            registerSubQueueTimer(ref.time);
+            notifyQueueChange(0);
             return handle;
         }
         else
@@ -152,24 +560,61 @@ public:
         }
     }
     template<typename TCallable>
-    inline TaskHandle sendDelayed(TCallable& newTask, const std::chrono::milliseconds& timeout)
+    inline TaskHandle sendPeriodic(TCallable& newTask, const std::chrono::milliseconds& period, PeriodicPolicy policy = PeriodicPolicy::FixedRate, Priority priority = Priority::Normal)
+    {
+        // Enforce reference to create a copy
+        TCallable tmp = newTask;
+        return sendPeriodic(std::move(tmp), period, policy, priority);
+    }
+    
+    /// @brief send a task that's executed only when the queue has nothing else to do - the task queue and sub-queues are empty and no delayed tasks are due
+    /// @param newTask - any callable object that will be executed on this thread, either with signature void(void) for tasks that are short
+    /// enough to run in one go, or bool(const IdleDeadline&) for tasks that split their work in time slices - the task should return once
+    /// IdleDeadline::getShouldYield() is true, and return true if it has more work to do, in which case it's executed again in the next idle time
+    /// @note idle tasks are executed in the order they were sent (a task that continues goes after the idle tasks that are waiting), those of
+    /// sub-queues are executed in the idle time of the root queue and idle tasks that are waiting when the queue stops are not executed
+    template<typename TCallable>
+    inline void sendIdle(TCallable&& newTask)
+    {
+        if (!getAcceptsTasks())
+        {
+            throw std::runtime_error("Task queue is not accepting any tasks, the thread has been signaled for stopping");
+        }
+        auto node = TaskNode::create(memoryResource, [callableObject = std::forward<TCallable>(newTask)]() mutable {
+            using TStored = decltype(callableObject);
+            if constexpr (std::is_invocable_r_v<bool, TStored&, const IdleDeadline&>)
+            {
+                auto& deadline = *getIdleDeadline();
+                deadline.isContinued = callableObject(static_cast<const IdleDeadline&>(deadline));
+            }
+            else
+            {
+                callableObject();
+            }
+        });
+        idleTasks->tasks.push(node.release());
+        notifyQueueChange();
+    }
+    template<typename TCallable>
+    inline void sendIdle(TCallable& newTask)
     {
         // Enforce reference to create a copy
         TCallable tmp = newTask;
-        return sendDelayed(std::move(tmp), timeout);
+        sendIdle(std::move(tmp));
     }
     
     /// @brief send an asynchronous task that returns value and needs to be executed on this thread (calling thread is not blocked)
     /// @note if sent from the same thread this method will call the callable immediatelly to prevent deadlocking
     /// @param newTask - any callable object that will be executed on this thread and it must return a value of type specified in TReturn (signature: TReturn(void))
+    /// @param priority - priority of the task
     template<typename TReturn, typename TCallable>
-    inline TaskHandleWithFuture<TReturn> sendAsync(TCallable&& newTask)
+    inline TaskHandleWithFuture<TReturn> sendAsync(TCallable&& newTask, Priority priority = Priority::Normal)
     {
         if (getAcceptsTasks())
         {
             std::promise<TReturn> promise;
             auto future = promise.get_future();
-            auto task = std::make_shared<TaskWithPromise<TReturn, TCallable>>(std::forward<TCallable>(newTask), std::move(promise));
+            auto task = std::allocate_shared<TaskWithPromise<TReturn, TCallable>>(std::pmr::polymorphic_allocator<Task>(memoryResource), std::forward<TCallable>(newTask), std::move(promise));
             TaskHandleWithFuture<TReturn> handle(task, std::move(future));
             if (getIsSameThread())
             {
@@ -178,8 +623,68 @@ public:
             }
             else
             {
-                const std::lock_guard lock(taskQueueMutex);
-                taskQueue.emplace(task);
+                auto node = createTaskNode(std::move(task));
+                acquireCapacity(1, node->getSize(), std::chrono::time_point<std::chrono::steady_clock>::max());
+                pushTask(std::move(node), priority);
+                notifyQueueChange();
+            }
+            return handle;
+        }
+        else
+        {
+            throw std::runtime_error("Task queue is not accepting any tasks, the thread has been signaled for stopping");
+        }
+    }
+    template<typename TReturn, typename TCallable>
+    inline TaskHandleWithFuture<TReturn> sendAsync(TCallable& newTask, Priority priority = Priority::Normal)
+    {
+        // Enforce reference to create a copy
+        TCallable tmp = newTask;
+        return sendAsync<TReturn>(std::move(tmp), priority);
+    }
+
+    /// @brief send an asynchronous task that is dropped if it has not been started by given time (see sendAsync())
+    /// @param newTask - any callable object that will be executed on this thread and it must return a value of type specified in TReturn (signature: TReturn(void))
+    /// @param expiryTime - time after which the caller is no longer interested in the result, an expired task is cancelled instead of
+    /// being started (TaskHandleWithFuture::getValue() throws std::future_error with broken_promise) and counted in Statistics::expiredCount
+    /// @param priority - priority of the task
+    template<typename TReturn, typename TCallable>
+    inline TaskHandleWithFuture<TReturn> sendAsync(TCallable&& newTask, std::chrono::time_point<std::chrono::steady_clock> expiryTime, Priority priority = Priority::Normal)
+    {
+        if (getAcceptsTasks())
+        {
+            std::promise<TReturn> promise;
+            auto future = promise.get_future();
+            auto task = std::allocate_shared<TaskWithPromise<TReturn, TCallable>>(std::pmr::polymorphic_allocator<Task>(memoryResource), std::forward<TCallable>(newTask), std::move(promise));
+            TaskHandleWithFuture<TReturn> handle(task, std::move(future));
+            if (getIsSameThread())
+            {
+                // If we are on the same thread excute task immediatelly to prevent a deadlock
+                if (std::chrono::steady_clock::now() < expiryTime)
+                {
+                    task->execute();
+                }
+                else
+                {
+                    task->cancel();
+                    expiredCount.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            else
+            {
+                auto node = createTaskNode(std::move(task));
+                node->setExpiryTime(expiryTime);
+                // Waiting for room is pointless once the task has expired, it would be dropped anyway
+                if (acquireCapacity(1, node->getSize(), expiryTime))
+                {
+                    pushTask(std::move(node), priority);
+                }
+                else
+                {
+                    node.reset();
+                    expiredCount.fetch_add(1, std::memory_order_relaxed);
+                    return handle;
+                }
                 notifyQueueChange();
             }
             return handle;
@@ -190,92 +695,304 @@ public:
         }
     }
     template<typename TReturn, typename TCallable>
-    inline TaskHandleWithFuture<TReturn> sendAsync(TCallable& newTask)
+    inline TaskHandleWithFuture<TReturn> sendAsync(TCallable& newTask, std::chrono::time_point<std::chrono::steady_clock> expiryTime, Priority priority = Priority::Normal)
     {
         // Enforce reference to create a copy
         TCallable tmp = newTask;
-        return sendAsync(std::move(tmp));
+        return sendAsync<TReturn>(std::move(tmp), expiryTime, priority);
     }
     
     /// @brief send a synchronous task that returns value and needs to be executed on this thread (calling thread is blocked until task returns)
     /// @note to prevent deadlocking this method throws exception if called before thread has started
     /// @param newTask - any callable object that will be executed on this thread and it must return a value of type specified in TReturn (signature: TReturn(void))
+    /// @param priority - priority of the task
     template<typename TReturn, typename TCallable>
-    inline TReturn sendSync(TCallable&& newTask)
+    inline TReturn sendSync(TCallable&& newTask, Priority priority = Priority::Normal)
     {
         if (!getAcceptsTasks())
         {
             throw std::runtime_error("Can not place a blocking task if the thread is not started");
         }
-        auto handle = sendAsync<TReturn>(std::forward<TCallable>(newTask));
+        auto handle = sendAsync<TReturn>(std::forward<TCallable>(newTask), priority);
         return handle.getValue();
     }
     template<typename TReturn, typename TCallable>
-    inline TReturn sendSync(TCallable& newTask)
+    inline TReturn sendSync(TCallable& newTask, Priority priority = Priority::Normal)
     {
         // Enforce reference to create a copy
         TCallable tmp = newTask;
-        return sendSync(std::move(tmp));
+        return sendSync<TReturn>(std::move(tmp), priority);
     }
     
     /// @brief send a task that needs to be executed on this thread and wait for it's completion
     /// @param newTask - any callable object that will be executed on this thread
+    /// @param priority - priority of the task
     template<typename TCallable>
-    inline void sendWait(TCallable&& newTask)
+    inline void sendWait(TCallable&& newTask, Priority priority = Priority::Normal)
     {
-        sendSync<void>(std::forward<TCallable>(newTask));
+        sendSync<void>(std::forward<TCallable>(newTask), priority);
     }
     template<typename TCallable>
-    inline void sendWait(TCallable& newTask)
+    inline void sendWait(TCallable& newTask, Priority priority = Priority::Normal)
     {
         // Enforce reference to create a copy
         TCallable tmp = newTask;
-        sendWait(std::move(tmp));
+        sendWait(std::move(tmp), priority);
     }
 
-    /// @brief Create a sub-queue who's ownership will be transfered to the caller
-    inline std::shared_ptr<TaskQueue> createSubQueue()
+    /// @brief send a task that has to be completed by given time
+    /// @param newTask - any callable object that will be executed on this thread
+    /// @param deadline - time the task has to be completed by, tasks that finish later are counted in Statistics::deadlineMissCount
+    /// @note with SchedulingMode::EarliestDeadlineFirst tasks sent with a deadline are taken before any other tasks in the order of their
+    /// deadlines, otherwise they are queued as tasks of normal priority
+    template<typename TCallable>
+    inline void sendWithDeadline(TCallable&& newTask, std::chrono::time_point<std::chrono::steady_clock> deadline)
     {
-        auto subQueue = std::make_shared<TaskQueue>([this](){
+        if (getAcceptsTasks())
+        {
+            auto node = TaskNode::create(memoryResource, std::forward<TCallable>(newTask));
+            node->setDeadline(deadline);
+            acquireCapacity(1, node->getSize(), std::chrono::time_point<std::chrono::steady_clock>::max());
+            if (schedulingMode == SchedulingMode::EarliestDeadlineFirst)
+            {
+                if (getIsMeasuringWaitTime())
+                {
+                    node->setSendTime(std::chrono::steady_clock::now());
+                }
+                deadlineQueue.push(node.release());
+                scheduleInParent();
+            }
+            else
+            {
+                pushTask(std::move(node));
+            }
             notifyQueueChange();
-        });
-        subQueue->setThreadId(threadId);
-        subQueue->setAcceptsTasks(getAcceptsTasks());
-        subQueues.push_back(subQueue);
-        return subQueue;
-    }
-    
-    /// @brief Check if we are on caller is on the same thread as the task queue
-    virtual inline bool getIsSameThread() const noexcept
-    {
-        return threadId == std::this_thread::get_id();
+        }
+        else
+        {
+            throw std::runtime_error("Task queue is not accepting any tasks, the thread has been signaled for stopping");
+        }
     }
-    
-    /// @brief Get if task queue accepts new tasks
-    inline bool getAcceptsTasks() const noexcept
+    template<typename TCallable>
+    inline void sendWithDeadline(TCallable& newTask, std::chrono::time_point<std::chrono::steady_clock> deadline)
     {
-        return acceptsTasks;
+        // Enforce reference to create a copy
+        TCallable tmp = newTask;
+        sendWithDeadline(std::move(tmp), deadline);
     }
-    
-    /// @brief Cancel all the tasks
-    inline void cancelAll() noexcept
+
+    /// @brief send multiple tasks at once - all of them are linked in the task queue with a single atomic operation and the thread is notified once
+    /// @param begin - iterator to the first callable object (objects are copied, use std::make_move_iterator to move them instead)
+    /// @param end - iterator past the last callable object
+    template<typename TIterator>
+    inline void sendBatch(TIterator begin, TIterator end)
     {
-        const std::lock_guard lock(taskQueueMutex);
-        delayedQueue.clear();
-        while (taskQueue.size())
-        {
-            taskQueue.pop();
-        }
-        for (auto& q : subQueues)
+        if (getAcceptsTasks())
         {
-            if (auto queue = q.lock())
+            TaskChain chain;
+            for (auto it = begin; it != end; ++it)
             {
-                queue->cancelAll();
+                chain.append(TaskNode::create(memoryResource, *it));
             }
+            acquireCapacity(chain.getSize(), chain.getTaskSize(), std::chrono::time_point<std::chrono::steady_clock>::max());
+            pushTasks(chain);
+        }
+        else
+        {
+            throw std::runtime_error("Task queue is not accepting any tasks, the thread has been signaled for stopping");
         }
     }
-    
-protected:
+    template<typename TCallable>
+    inline void sendBatch(std::initializer_list<TCallable> newTasks)
+    {
+        sendBatch(newTasks.begin(), newTasks.end());
+    }
+
+    /// @brief send multiple asynchronous tasks that return values at once (see sendAsync() and sendBatch())
+    /// @param begin - iterator to the first callable object (objects are copied, use std::make_move_iterator to move them instead)
+    /// @param end - iterator past the last callable object
+    /// @return handles to task results in the same order as callable objects
+    template<typename TReturn, typename TIterator>
+    inline std::vector<TaskHandleWithFuture<TReturn>> sendAsyncBatch(TIterator begin, TIterator end)
+    {
+        using TCallable = std::decay_t<decltype(*begin)>;
+        if (getAcceptsTasks())
+        {
+            std::vector<TaskHandleWithFuture<TReturn>> handles;
+            TaskChain chain;
+            const auto isSameThread = getIsSameThread();
+            for (auto it = begin; it != end; ++it)
+            {
+                std::promise<TReturn> promise;
+                auto future = promise.get_future();
+                auto task = std::allocate_shared<TaskWithPromise<TReturn, TCallable>>(std::pmr::polymorphic_allocator<Task>(memoryResource), TCallable(*it), std::move(promise));
+                handles.emplace_back(task, std::move(future));
+                if (isSameThread)
+                {
+                    // If we are on the same thread excute task immediatelly to prevent a deadlock
+                    task->execute();
+                }
+                else
+                {
+                    chain.append(createTaskNode(std::move(task)));
+                }
+            }
+            acquireCapacity(chain.getSize(), chain.getTaskSize(), std::chrono::time_point<std::chrono::steady_clock>::max());
+            pushTasks(chain);
+            return handles;
+        }
+        else
+        {
+            throw std::runtime_error("Task queue is not accepting any tasks, the thread has been signaled for stopping");
+        }
+    }
+    template<typename TReturn, typename TCallable>
+    inline std::vector<TaskHandleWithFuture<TReturn>> sendAsyncBatch(std::initializer_list<TCallable> newTasks)
+    {
+        return sendAsyncBatch<TReturn>(newTasks.begin(), newTasks.end());
+    }
+
+    /// @brief Create a sub-queue who's ownership will be transfered to the caller
+    /// @param weight - share of this queue's time the sub-queue gets relative to other sub-queues and tasks sent to this queue directly
+    /// (which have a weight of 1), i.e. a sub-queue with weight 2 gets twice the execution time of a sub-queue with weight 1 when
+    /// both of them are busy
+    inline std::shared_ptr<TaskQueue> createSubQueue(std::size_t weight = 1)
+    {
+        TaskQueueOptions subQueueOptions;
+        subQueueOptions.memoryResource = memoryResource;
+        subQueueOptions.priorityAgingInterval = priorityAgingInterval;
+        subQueueOptions.schedulingMode = schedulingMode;
+        subQueueOptions.fairShareCost = fairShareCost;
+        subQueueOptions.timerBackend = timingWheel ? TimerBackend::TimingWheel : TimerBackend::OrderedSet;
+        subQueueOptions.timerResolution = std::chrono::duration_cast<std::chrono::microseconds>(timerResolution);
+        subQueueOptions.timerService = serviceTimer ? &serviceTimer->getService() : nullptr;
+        auto subQueue = std::shared_ptr<TaskQueue>(new TaskQueue([this](std::size_t taskCount){
+            notifyQueueChange(taskCount);
+        }, subQueueOptions, nullptr, hasSingleConsumer));
+        // Sub-queue wakes up our threads directly instead of going through our notify callback
+        subQueue->eventCount = eventCount;
+        subQueue->idleTasks = idleTasks;
+        subQueue->setThreadId(threadId);
+        subQueue->setAcceptsTasks(getAcceptsTasks());
+        subQueue->parentLink = std::make_shared<SubQueueLink>(subQueue, subQueueList, weight);
+        // Sub-queues of the sub-queue schedule it in our ready list through this link
+        subQueue->subQueueList->ownerLink = subQueue->parentLink;
+        const std::lock_guard lock(subQueueList->mutex);
+        subQueue->parentPosition = subQueueList->queues.insert(subQueueList->queues.end(), subQueue);
+        return subQueue;
+    }
+    
+    /// @brief Check if we are on caller is on the same thread as the task queue
+    virtual inline bool getIsSameThread() const noexcept
+    {
+        return threadId == std::this_thread::get_id();
+    }
+    
+    /// @brief Get if task queue accepts new tasks
+    inline bool getAcceptsTasks() const noexcept
+    {
+        return acceptsTasks;
+    }
+
+    /// @brief Get task queue counters
+    inline Statistics getStatistics() const noexcept
+    {
+        Statistics statistics;
+        statistics.executedCount = executedCount.load(std::memory_order_relaxed);
+        statistics.executionTime = std::chrono::nanoseconds(executionTime.load(std::memory_order_relaxed));
+        statistics.totalWaitTime = std::chrono::nanoseconds(totalWaitTime.load(std::memory_order_relaxed));
+        statistics.maxWaitTime = std::chrono::nanoseconds(maxWaitTime.load(std::memory_order_relaxed));
+        statistics.deadlineMissCount = deadlineMissCount.load(std::memory_order_relaxed);
+        statistics.expiredCount = expiredCount.load(std::memory_order_relaxed);
+        statistics.shedCount = shedCount.load(std::memory_order_relaxed);
+        statistics.rejectedCount = rejectedCount.load(std::memory_order_relaxed);
+        statistics.pendingCount = pendingCount.load(std::memory_order_relaxed);
+        statistics.queueDelay = std::chrono::nanoseconds(queueDelay.load(std::memory_order_relaxed));
+        return statistics;
+    }
+    
+    /// @brief Cancel all the tasks
+    inline void cancelAll() noexcept
+    {
+        const std::lock_guard lock(taskQueueMutex);
+        // Tasks that were already taken by the queue thread, but not executed yet, are cancelled too
+        cancelCount.fetch_add(1, std::memory_order_relaxed);
+        {
+            const std::lock_guard delayedLock(delayedTaskOwner->mutex);
+            clearDelayedTasks();
+        }
+        keyedTimers.clear();
+        keyedTimerQueue.clear();
+        for (auto& timer : periodicQueue)
+        {
+            timer.second->cancel();
+            // Task that's running right now finds out it's been dropped once it's done
+            timer.second->position = periodicQueue.end();
+        }
+        periodicQueue.clear();
+        clearTasks();
+        if (!parentLink)
+        {
+            // Idle tasks of sub-queues are mixed with ours, so they are only cleared by the root queue
+            idleTasks->clear();
+        }
+        for (auto& queue : getSubQueues())
+        {
+            queue->cancelAll();
+        }
+    }
+    
+protected:
+    /// @param initQueueNotifyCallback - callback that get's called with the number of new tasks whenever a task queue changes it's contents
+    /// (the number is 0 if only the schedule has changed, i.e. a delayed task was added)
+    /// @param initEventCount - event count the queue threads wait on, if set new tasks are signaled directly through it and the callback
+    /// is only called for schedule changes
+    /// @param initHasSingleConsumer - set if tasks are executed by a single thread (it's decided up front, so that queue threads never
+    /// have to make a virtual call that could race with destruction of the derived queue)
+    TaskQueue(const std::function<void(std::size_t)>& initQueueNotifyCallback,
+              const TaskQueueOptions& initOptions,
+              std::shared_ptr<EventCount> initEventCount = nullptr,
+              bool initHasSingleConsumer = true)
+        : eventCount(std::move(initEventCount))
+        , idleTasks(std::allocate_shared<IdleTaskList>(std::pmr::polymorphic_allocator<IdleTaskList>(initOptions.memoryResource)))
+        , idleTimeSlice(initOptions.idleTimeSlice)
+        , memoryResource(initOptions.memoryResource)
+        , maxBatchSize(std::max<std::size_t>(initOptions.maxBatchSize, 1))
+        , maxBatchDuration(initOptions.maxBatchDuration)
+        , idlePolicy(initOptions.idlePolicy)
+        , maxSpinDuration(initOptions.maxSpinDuration)
+        , timerPrecision(initOptions.timerPrecision)
+        , timerSpinDuration(initOptions.timerSpinDuration)
+        , priorityAgingInterval(initOptions.priorityAgingInterval)
+        , schedulingMode(initOptions.schedulingMode)
+        , fairShareCost(initOptions.fairShareCost)
+        , deadlineTasks(initOptions.memoryResource)
+        , delayedTaskOwner(std::allocate_shared<DelayedTaskOwner>(std::pmr::polymorphic_allocator<DelayedTaskOwner>(initOptions.memoryResource)))
+        , delayedQueue(initOptions.memoryResource)
+        , timingWheel(initOptions.timerBackend == TimerBackend::TimingWheel ? std::make_unique<TimingWheel<DelayedTask>>() : nullptr)
+        , timerOrigin(std::chrono::steady_clock::now())
+        , timerResolution(std::max(initOptions.timerResolution, std::chrono::microseconds(1)))
+        , keyedTimerQueue(initOptions.memoryResource)
+        , keyedTimers(initOptions.memoryResource)
+        , periodicQueue(initOptions.memoryResource)
+        , capacity(initOptions.capacity)
+        , capacitySize(initOptions.capacitySize)
+        , capacityEventCount(capacity != 0 || capacitySize != 0 ? std::make_unique<EventCount>() : nullptr)
+        , loadSheddingDepth(initOptions.loadSheddingDepth)
+        , loadSheddingAge(initOptions.loadSheddingAge)
+        , isCountingTasks(capacityEventCount || loadSheddingDepth != 0)
+        , hasSingleConsumer(initHasSingleConsumer)
+        , queueNotifyCallback(initQueueNotifyCallback)
+    {
+        delayedTaskOwner->queue = this;
+        if (initOptions.timerService)
+        {
+            serviceTimer = std::make_unique<TimerService::Timer>(*initOptions.timerService, [this](std::chrono::time_point<std::chrono::steady_clock> timeNow){
+                return updateServiceTimer(timeNow);
+            });
+        }
+    }
+
     /// @brief base class for thread task
     class Task
     {
@@ -313,6 +1030,11 @@ protected:
             
             privateCancel();
         }
+        /// @brief check if the task has been cancelled
+        inline bool getIsCanceled() const noexcept
+        {
+            return state.load(std::memory_order_acquire) == ExecutionState::Canceled;
+        }
     protected:
         
         virtual void privateExecute() = 0;
@@ -330,15 +1052,142 @@ protected:
         std::atomic<ExecutionState> state { ExecutionState::Queued };
     };
     
-    /// @brief templated task to wrap a callable object
+    /// @brief a chain of task nodes that is linked in the task queue all at once
+    class TaskChain
+    {
+    public:
+        TaskChain() = default;
+        TaskChain(const TaskChain&) = delete;
+        TaskChain& operator=(const TaskChain&) = delete;
+        TaskChain(TaskChain&&) = delete;
+        TaskChain& operator=(TaskChain&&) = delete;
+        ~TaskChain()
+        {
+            // Chain was never pushed (i.e. one of the tasks threw while being created) or executed, so we own the nodes
+            clear();
+        }
+        inline void append(TaskNodePtr node) noexcept
+        {
+            taskSize += node->getSize();
+            auto ptr = node.release();
+            if (last)
+            {
+                IntrusiveMpscQueue<TaskNode>::link(last, ptr);
+            }
+            else
+            {
+                first = ptr;
+            }
+            last = ptr;
+            ++count;
+        }
+        inline TaskNode* getFirst() const noexcept
+        {
+            return first;
+        }
+        inline TaskNode* getLast() const noexcept
+        {
+            return last;
+        }
+        inline std::size_t getSize() const noexcept
+        {
+            return count;
+        }
+        /// @brief get the total size of the tasks in bytes (see TaskNode::getSize())
+        inline std::size_t getTaskSize() const noexcept
+        {
+            return taskSize;
+        }
+        /// @brief unlink the first node of the chain
+        /// @return a node or nullptr if the chain is empty
+        inline TaskNodePtr popFront() noexcept
+        {
+            auto node = first;
+            if (node)
+            {
+                first = node != last ? IntrusiveMpscQueue<TaskNode>::getNext(node) : nullptr;
+                if (!first)
+                {
+                    last = nullptr;
+                }
+                --count;
+                taskSize -= node->getSize();
+            }
+            return TaskNodePtr(node);
+        }
+        /// @brief destroy all the nodes in the chain
+        inline void clear() noexcept
+        {
+            while (popFront())
+            {}
+        }
+        /// @brief release ownership of the nodes after they have been linked in the task queue
+        inline void release() noexcept
+        {
+            first = nullptr;
+            last = nullptr;
+            count = 0;
+            taskSize = 0;
+        }
+    private:
+        TaskNode* first { nullptr };
+        TaskNode* last { nullptr };
+        std::size_t count { 0 };
+        std::size_t taskSize { 0 };
+    };
+
+    class PeriodicTask;
+    using PeriodicTimerQueue = std::pmr::multimap<std::chrono::time_point<std::chrono::steady_clock>, std::shared_ptr<PeriodicTask>>;
+    
+    /// @brief base class for tasks sent with sendPeriodic(), the task is executed over and over again until it's cancelled
+    class PeriodicTask : public Task
+    {
+    public:
+        PeriodicTask(std::chrono::steady_clock::duration initPeriod, PeriodicPolicy initPolicy, Priority initPriority)
+            : period(initPeriod)
+            , policy(initPolicy)
+            , priority(initPriority)
+        {}
+        /// @brief execute the task without finishing it, so that it can be executed again
+        inline void run()
+        {
+            if (!getIsCanceled())
+            {
+                privateExecute();
+            }
+        }
+        inline std::chrono::steady_clock::duration getPeriod() const noexcept
+        {
+            return period;
+        }
+        inline PeriodicPolicy getPolicy() const noexcept
+        {
+            return policy;
+        }
+        inline Priority getPriority() const noexcept
+        {
+            return priority;
+        }
+        /// @brief time the task is scheduled for (only accessed with taskQueueMutex locked)
+        std::chrono::time_point<std::chrono::steady_clock> time {};
+        /// @brief position of the task in periodicQueue, end() once it's been dropped by cancelAll() (only accessed with taskQueueMutex locked)
+        PeriodicTimerQueue::iterator position;
+    private:
+        std::chrono::steady_clock::duration period;
+        PeriodicPolicy policy;
+        Priority priority;
+    };
+    
+    /// @brief templated periodic task to wrap a callable object
     template<typename TCallable>
-    class TaskWithCallable : public Task
+    class PeriodicTaskWithCallable : public PeriodicTask
     {
     public:
-        TaskWithCallable(TCallable&& initCallableObject)
-            : callableObject(std::forward<TCallable>(initCallableObject))
+        PeriodicTaskWithCallable(TCallable&& initCallableObject, std::chrono::steady_clock::duration initPeriod, PeriodicPolicy initPolicy, Priority initPriority)
+            : PeriodicTask(initPeriod, initPolicy, initPriority)
+            , callableObject(std::forward<TCallable>(initCallableObject))
         {}
-        ~TaskWithCallable() override
+        ~PeriodicTaskWithCallable() override
         {
             cancel();
         }
@@ -353,6 +1202,145 @@ protected:
         TCallable callableObject;
     };
     
+    /// @brief task queue node of a single execution of a periodic task, it schedules the next execution once it's done
+    class PeriodicTaskRun
+    {
+    public:
+        PeriodicTaskRun(TaskQueue* initQueue, std::shared_ptr<PeriodicTask> initTask)
+            : queue(initQueue)
+            , task(std::move(initTask))
+        {
+            if (queue->parentLink)
+            {
+                // Sub-queue can be destroyed while the task is running
+                subQueue = queue->parentLink->queue;
+            }
+        }
+        inline void operator()()
+        {
+            try
+            {
+                task->run();
+            }
+            catch (...)
+            {
+                schedule();
+                throw;
+            }
+            schedule();
+        }
+    private:
+        TaskQueue* queue;
+        std::weak_ptr<TaskQueue> subQueue;
+        std::shared_ptr<PeriodicTask> task;
+
+        inline void schedule()
+        {
+            if (!queue->parentLink)
+            {
+                queue->schedulePeriodicTask(*task);
+            }
+            else if (auto q = subQueue.lock())
+            {
+                q->schedulePeriodicTask(*task);
+            }
+        }
+    };
+    
+    /// @brief tasks sent with sendCoalesced() that are waiting in the queue, it's shared with the queued nodes so that they can outlive the queue
+    struct CoalescedTaskMap
+    {
+        CoalescedTaskMap(std::pmr::memory_resource* memoryResource)
+            : tasks(memoryResource)
+        {}
+        std::mutex mutex;
+        std::pmr::unordered_map<std::size_t, TaskNodePtr> tasks;
+    };
+
+    /// @brief callable object of a queued node that executes whatever task is in the map entry of it's key at the time
+    class CoalescedTask
+    {
+    public:
+        CoalescedTask(std::shared_ptr<CoalescedTaskMap> initMap, std::size_t initKey)
+            : map(std::move(initMap))
+            , key(initKey)
+        {}
+        CoalescedTask(const CoalescedTask&) = delete;
+        CoalescedTask& operator=(const CoalescedTask&) = delete;
+        CoalescedTask(CoalescedTask&& other) noexcept
+            : map(std::move(other.map))
+            , key(other.key)
+        {}
+        CoalescedTask& operator=(CoalescedTask&&) = delete;
+        ~CoalescedTask()
+        {
+            // Task was never executed, release the map entry, so that the key can be sent again
+            take();
+        }
+        inline void operator()()
+        {
+            if (auto node = take())
+            {
+                node->execute();
+            }
+        }
+    private:
+        std::shared_ptr<CoalescedTaskMap> map;
+        std::size_t key;
+
+        inline TaskNodePtr take() noexcept
+        {
+            TaskNodePtr node;
+            if (map)
+            {
+                const std::lock_guard lock(map->mutex);
+                auto it = map->tasks.find(key);
+                if (it != map->tasks.end())
+                {
+                    node = std::move(it->second);
+                    map->tasks.erase(it);
+                }
+                map.reset();
+            }
+            return node;
+        }
+    };
+
+    /// @brief templated task to wrap a callable object and a callable object that's called if the task is cancelled
+    template<typename TCallable, typename TCancelCallable>
+    class TaskWithCancelCallback : public Task
+    {
+    public:
+        template<typename TInitCallable, typename TInitCancelCallable>
+        TaskWithCancelCallback(TInitCallable&& initCallableObject, TInitCancelCallable&& initCancelCallableObject)
+            : callableObject(std::forward<TInitCallable>(initCallableObject))
+            , cancelCallableObject(std::forward<TInitCancelCallable>(initCancelCallableObject))
+        {}
+        ~TaskWithCancelCallback() override
+        {
+            cancel();
+        }
+    protected:
+        inline void privateExecute() override
+        {
+            callableObject();
+        }
+        inline void privateCancel() override
+        {
+            try
+            {
+                cancelCallableObject();
+            }
+            catch(...)
+            {
+                // We can't do nothing as nobody is listening, but we don't want the thread to explode
+            }
+        }
+    private:
+        TCallable callableObject;
+        TCancelCallable cancelCallableObject;
+    };
+
     /// @brief templated task to wrap a callable object which accepts promise object that can be used to signal finish of the callable (useful for subsequent async calls)
     template<typename TReturn, typename TCallable>
     class TaskWithPromise : public Task
@@ -415,20 +1403,29 @@ protected:
         }
     };
     
-    /// @brief templated task to wrap a callable object
+    class DelayedTask;
+    
+    /// @brief entry of the ordered set of delayed tasks (see TimerBackend::OrderedSet), entries are ordered by the latest time the task
+    /// has to be moved to the task queue
     class DelayedTaskWrapper
     {
     public:
         DelayedTaskWrapper(std::chrono::time_point<std::chrono::steady_clock> initTime,
-                           std::shared_ptr<Task> initTask)
+                           std::chrono::time_point<std::chrono::steady_clock> initEarliestTime,
+                           std::shared_ptr<DelayedTask> initTask)
             : time(initTime)
+            , earliestTime(initEarliestTime)
             , task(std::move(initTask))
         {}
-        inline bool operator<(const DelayedTaskWrapper& other)
+        inline bool operator<(const DelayedTaskWrapper& other) const noexcept
         {
             return time < other.getTime();
         }
-        inline std::shared_ptr<Task>& getTask()
+        inline std::shared_ptr<DelayedTask>& getTask()
+        {
+            return task;
+        }
+        inline const std::shared_ptr<DelayedTask>& getTask() const
         {
             return task;
         }
@@ -436,220 +1433,1649 @@ protected:
         {
             return time;
         }
+        /// @brief get the time before which the task must not be moved to the task queue (the same as getTime() unless it has a tolerance)
+        inline std::chrono::time_point<std::chrono::steady_clock> getEarliestTime() const noexcept
+        {
+            return earliestTime;
+        }
     private:
-        const std::chrono::time_point<std::chrono::steady_clock> time {};
-        std::shared_ptr<Task> task;
+        std::chrono::time_point<std::chrono::steady_clock> time {};
+        std::chrono::time_point<std::chrono::steady_clock> earliestTime {};
+        std::shared_ptr<DelayedTask> task;
     };
     
-    inline std::chrono::time_point<std::chrono::steady_clock> enqueueDelayedTasks(std::chrono::time_point<std::chrono::steady_clock> timeNow)
+    using DelayedTaskQueue = std::pmr::multiset<DelayedTaskWrapper>;
+    
+    /// @brief owner of the delayed tasks of a queue, it's shared with the tasks so that a cancelled task can remove itself from the queue
+    /// @note delayed task containers of the queue are guarded by the mutex and the queue is reset to nullptr once it's destroyed
+    struct DelayedTaskOwner
     {
-        const std::lock_guard lock(taskQueueMutex);
-        for (auto it = delayedQueue.begin(); it != delayedQueue.end();)
-        {
-            if ((*it)->getTime() < timeNow)
-            {
-                auto& ptr = (*it)->getTask();
-                if (ptr)
-                {
-                    taskQueue.emplace(std::move(ptr));
-                }
-                it = delayedQueue.erase(it);
-            }
-            else
-            {
-                break;
-            }
-        }
-        auto timeNext = timeNow;
-        if (!delayedQueue.empty())
+        std::recursive_mutex mutex;
+        TaskQueue* queue { nullptr };
+    };
+    
+    /// @brief base class for tasks sent with sendDelayed(), the task is linked either in the ordered set or in the timing wheel of it's queue
+    class DelayedTask : public Task, public TimingWheelNode
+    {
+    public:
+        DelayedTask(std::shared_ptr<DelayedTaskOwner> initOwner, Priority initPriority)
+            : owner(std::move(initOwner))
+            , priority(initPriority)
+        {}
+        inline Priority getPriority() const noexcept
         {
-            timeNext = (*delayedQueue.begin())->getTime();
+            return priority;
         }
-        // Check for sub-queue closest delayed task deadline
-        for (auto q : subQueues)
+        /// @brief set while the task is linked in it's queue (only accessed with owner's mutex locked)
+        bool isLinked { false };
+        /// @brief position of the task in the ordered set (only used with TimerBackend::OrderedSet)
+        DelayedTaskQueue::iterator position;
+        /// @brief reference that keeps the task alive while it's linked in the timing wheel (only used with TimerBackend::TimingWheel)
+        std::shared_ptr<DelayedTask> self;
+    protected:
+        inline void privateCancel() override
         {
-            if (auto queue = q.lock())
+            const std::lock_guard lock(owner->mutex);
+            if (isLinked && owner->queue)
             {
-                auto nextTime = queue->enqueueDelayedTasks(timeNow);
-                if (nextTime != timeNow && (nextTime < timeNext || timeNext == timeNow))
-                {
-                    timeNext = nextTime;
-                }
+                owner->queue->removeDelayedTask(*this);
             }
         }
-        return timeNext;
-    }
+    private:
+        std::shared_ptr<DelayedTaskOwner> owner;
+        Priority priority;
+    };
     
-    inline void setThreadId(std::thread::id newThreadId)
+    /// @brief templated delayed task to wrap a callable object
+    template<typename TCallable>
+    class DelayedTaskWithCallable : public DelayedTask
     {
-        const std::lock_guard lock(taskQueueMutex);
-        threadId = newThreadId;
-        for (auto& q : subQueues)
+    public:
+        DelayedTaskWithCallable(TCallable&& initCallableObject, std::shared_ptr<DelayedTaskOwner> initOwner, Priority initPriority)
+            : DelayedTask(std::move(initOwner), initPriority)
+            , callableObject(std::forward<TCallable>(initCallableObject))
+        {}
+        ~DelayedTaskWithCallable() override
         {
-            if (auto queue = q.lock())
-            {
-                queue->setThreadId(newThreadId);
-            }
+            cancel();
         }
-    }
+    protected:
+        inline void privateExecute() override
+        {
+            callableObject();
+        }
+    private:
+        TCallable callableObject;
+    };
     
-    inline void setAcceptsTasks(bool newAcceptsTasks)
+    using KeyedTimerQueue = std::pmr::multimap<std::chrono::time_point<std::chrono::steady_clock>, std::size_t>;
+
+    /// @brief timer of a debounce() or throttle() key
+    struct KeyedTimer
     {
-        const std::lock_guard lock(taskQueueMutex);
-        acceptsTasks = newAcceptsTasks;
-        for (auto& q : subQueues)
+        /// @brief task that's executed when the timer expires (nullptr if there is none)
+        TaskNodePtr task;
+        Priority priority { Priority::Normal };
+        /// @brief throttling interval (zero if the timer belongs to debounce())
+        std::chrono::steady_clock::duration interval { 0 };
+        /// @brief position of the timer in keyedTimerQueue
+        KeyedTimerQueue::iterator position {};
+    };
+
+    struct SubQueueLink;
+
+    /// @brief tasks taken from the task queue by a thread, but not executed yet
+    struct TaskBatch
+    {
+        TaskChain tasks;
+        /// @brief value of TaskQueue::cancelCount when the first task was taken
+        std::size_t cancelCount { 0 };
+        /// @brief links of the sub-queues the tasks were taken through (empty if they come from the main queue)
+        std::vector<std::shared_ptr<SubQueueLink>> path;
+        /// @brief priority of the tasks (all the tasks of a batch are taken from the same priority level)
+        Priority priority { Priority::Normal };
+        /// @brief set if the batch holds a task taken in the order of deadlines (such tasks are taken one at a time)
+        bool isDeadlineOrdered { false };
+    };
+
+    /// @brief entry of the deadline heap
+    struct DeadlineTask
+    {
+        /// @brief orders entries in a heap by their deadline and then by the order they were sent, earliest first
+        struct Compare
         {
-            if (auto queue = q.lock())
+            inline bool operator()(const DeadlineTask& a, const DeadlineTask& b) const noexcept
             {
-                queue->setAcceptsTasks(newAcceptsTasks);
+                return a.deadline != b.deadline ? a.deadline > b.deadline : a.sequence > b.sequence;
             }
-        }
-    }
+        };
+
+        std::chrono::time_point<std::chrono::steady_clock> deadline;
+        std::uint64_t sequence { 0 };
+        TaskNodePtr node;
+    };
+
+    /// @brief run loop state of the calling thread
+    struct RunLoopContext
+    {
+        /// @brief queue that is running it's run loop on this thread
+        TaskQueue* queue { nullptr };
+        /// @brief batch of tasks that is being executed
+        TaskBatch* batch { nullptr };
+    };
+
+    static inline RunLoopContext& getRunLoopContext() noexcept
+    {
+        thread_local RunLoopContext context;
+        return context;
+    }
+
+    /// @brief get the time slice of the idle task that's being executed on this thread (nullptr if there is none)
+    static inline IdleDeadline*& getIdleDeadline() noexcept
+    {
+        thread_local IdleDeadline* deadline { nullptr };
+        return deadline;
+    }
+
+    /// @brief tasks sent with sendIdle(), it's shared by the root queue with all of it's sub-queues
+    struct IdleTaskList
+    {
+        IdleTaskList() = default;
+        IdleTaskList(const IdleTaskList&) = delete;
+        IdleTaskList& operator=(const IdleTaskList&) = delete;
+        ~IdleTaskList()
+        {
+            clear();
+        }
+        /// @brief destroy all the tasks without executing them
+        /// @note only one consumer can pop tasks at a time, so this has to be called with root queue's taskQueueMutex locked (or from destructor)
+        inline void clear() noexcept
+        {
+            while (auto node = TaskNodePtr(tasks.pop()))
+            {}
+        }
+        IntrusiveMpscQueue<TaskNode> tasks;
+    };
+
+    struct SubQueueList;
+
+    /// @brief sub-queue's entry in it's parent queue
+    struct SubQueueLink : public MpscQueueNode, public std::enable_shared_from_this<SubQueueLink>
+    {
+        /// @brief orders links in a heap by their pass, lowest first
+        struct ComparePass
+        {
+            inline bool operator()(const std::shared_ptr<SubQueueLink>& a, const std::shared_ptr<SubQueueLink>& b) const noexcept
+            {
+                return a->pass > b->pass;
+            }
+        };
+
+        SubQueueLink(std::weak_ptr<TaskQueue> initQueue, std::shared_ptr<SubQueueList> initParentList, std::size_t initWeight)
+            : queue(std::move(initQueue))
+            , parentList(std::move(initParentList))
+            , weight(std::max<std::size_t>(initWeight, 1))
+        {}
+        std::weak_ptr<TaskQueue> queue;
+        std::shared_ptr<SubQueueList> parentList;
+        /// @brief share of parent's time the sub-queue gets relative to it's siblings and parent's own tasks (which have weight of 1)
+        const std::size_t weight;
+        /// @brief virtual time of the sub-queue in parent's schedule (only accessed by parent's consumer)
+        std::uint64_t pass { 0 };
+        /// @brief average cost of a task taken through this link in nanoseconds
+        std::atomic<std::uint64_t> cost { 0 };
+        /// @brief set while the link is in parent's ready list (or it's being consumed), so that it's never linked twice
+        std::atomic_bool isReady { false };
+        /// @brief keeps the link alive while it's in parent's ready list
+        std::shared_ptr<SubQueueLink> readyReference;
+    };
+
+    /// @brief sub-queues of a task queue, it's shared with the sub-queues so that they can outlive their parent
+    struct SubQueueList
+    {
+        SubQueueList() = default;
+        SubQueueList(const SubQueueList&) = delete;
+        SubQueueList& operator=(const SubQueueList&) = delete;
+        ~SubQueueList()
+        {
+            // Nobody is consuming the ready list any more, drop the links that are still in it
+            while (auto link = readyQueues.pop())
+            {
+                auto reference = std::move(link->readyReference);
+            }
+        }
+        /// @brief guards queues and timers
+        std::mutex mutex;
+        /// @brief living sub-queues in creation order, a sub-queue removes itself on destruction
+        std::list<std::weak_ptr<TaskQueue>> queues;
+        /// @brief sub-queues that have tasks to execute in the order they became ready
+        IntrusiveMpscQueue<SubQueueLink> readyQueues;
+        /// @brief times at which sub-queues have delayed tasks due (entries of cancelled tasks are left to expire)
+        std::multimap<std::chrono::time_point<std::chrono::steady_clock>, std::weak_ptr<SubQueueLink>> timers;
+        /// @brief link of the queue owning this list in it's own parent (nullptr if the owner is not a sub-queue)
+        std::shared_ptr<SubQueueLink> ownerLink;
+    };
+
+    /// @brief link a sub-queue in it's parent's ready list, and it's parents in theirs, unless they are there already
+    /// @note a sub-queue is linked at most once, so the ready list only grows when a sub-queue goes from empty to non-empty
+    static inline void scheduleSubQueue(SubQueueLink* link) noexcept
+    {
+        // Pairs with the fence in acquireSubQueueTask(), either the consumer sees our tasks or we see the link released
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (link && !link->isReady.load(std::memory_order_relaxed) && !link->isReady.exchange(true, std::memory_order_acq_rel))
+        {
+            link->readyReference = link->shared_from_this();
+            auto list = link->parentList.get();
+            list->readyQueues.push(link);
+            link = list->ownerLink.get();
+        }
+    }
+
+    /// @brief get the batch a task sent from the calling thread can be appended to without breaking FIFO order
+    /// @note the task is only appended if it would be taken next anyway, i.e. it's not a batch of a sub-queue, no sub-queue is due and no other
+    /// priority level goes first, and it's charged to main queue's pass as if it had been taken from the queue
+    /// @return a batch or nullptr if the task has to go through the shared queue
+    inline TaskBatch* getLocalBatch(Priority priority)
+    {
+        const auto& context = getRunLoopContext();
+        if (context.queue != this || context.batch->isDeadlineOrdered || !context.batch->path.empty() || context.batch->priority != priority || !getTaskQueue(priority).drained())
+        {
+            return nullptr;
+        }
+        const std::lock_guard lock(taskQueueMutex);
+        if (!deadlineQueue.empty() || !deadlineTasks.empty() || !getIsPriorityNext(priority))
+        {
+            return nullptr;
+        }
+        scheduleReadySubQueues();
+        if (!getIsMainPassNext())
+        {
+            return nullptr;
+        }
+        mainPass += getPassIncrement(getChargedCost(mainCost), 1);
+        const auto currentCancelCount = cancelCount.load(std::memory_order_relaxed);
+        if (context.batch->cancelCount != currentCancelCount)
+        {
+            // cancelAll() was called from a task of this batch, the rest of the batch is cancelled, but a new task has to survive
+            context.batch->tasks.clear();
+            context.batch->cancelCount = currentCancelCount;
+        }
+        return context.batch;
+    }
+
+    /// @brief move due delayed tasks to the task queue and schedule sub-queues that have delayed tasks due
+    /// @note the work is only done if any of the delayed tasks are due or the schedule has changed since the last call
+    /// @return time of the next delayed task or time_point::max() if there are none
+    inline std::chrono::time_point<std::chrono::steady_clock> updateSchedule(std::chrono::time_point<std::chrono::steady_clock> timeNow)
+    {
+        const auto isChanged = scheduleChanged.load(std::memory_order_relaxed) && scheduleChanged.exchange(false, std::memory_order_acq_rel);
+        if (!isChanged && timeNow < nextDelayedTime.load(std::memory_order_acquire))
+        {
+            return nextDelayedTime.load(std::memory_order_acquire);
+        }
+        const std::lock_guard lock(taskQueueMutex);
+        std::size_t delayedCount { 0 };
+        // Delayed tasks of a queue that uses a timer service are moved by the service thread
+        auto timeNext = serviceTimer ? std::chrono::time_point<std::chrono::steady_clock>::max() : updateDelayedTasks(timeNow, delayedCount);
+        while (!periodicQueue.empty() && periodicQueue.begin()->first < timeNow)
+        {
+            auto& task = periodicQueue.begin()->second;
+            if (task->getIsCanceled())
+            {
+                periodicQueue.erase(periodicQueue.begin());
+                continue;
+            }
+            // Periodic tasks are already in the queue's care, so they are admitted even if the queue is full
+            auto taskNode = TaskNode::create(memoryResource, PeriodicTaskRun { this, task });
+            addCapacity(1, taskNode->getSize());
+            pushTask(std::move(taskNode), task->getPriority());
+            // Task waits at the end of the timer queue until it's been executed, so that only one execution is queued at a time
+            movePeriodicTask(*task, std::chrono::time_point<std::chrono::steady_clock>::max());
+        }
+        if (!periodicQueue.empty())
+        {
+            timeNext = std::min(timeNext, periodicQueue.begin()->first);
+        }
+        timeNext = std::min(timeNext, updateKeyedTimers(timeNow));
+        // Sub-queues move their own delayed tasks once they are taken from the ready list
+        {
+            const std::lock_guard listLock(subQueueList->mutex);
+            auto& timers = subQueueList->timers;
+            while (!timers.empty() && timers.begin()->first < timeNow)
+            {
+                if (auto link = timers.begin()->second.lock())
+                {
+                    scheduleSubQueue(link.get());
+                }
+                timers.erase(timers.begin());
+            }
+            if (!timers.empty())
+            {
+                timeNext = std::min(timeNext, timers.begin()->first);
+            }
+        }
+        nextDelayedTime.store(timeNext, std::memory_order_release);
+        return timeNext;
+    }
+    
+    /// @brief move tasks of expired debounce() and throttle() timers to the task queue
+    /// @note this has to be called with taskQueueMutex locked
+    /// @return time at which the keyed timers have to be looked at again
+    inline std::chrono::time_point<std::chrono::steady_clock> updateKeyedTimers(std::chrono::time_point<std::chrono::steady_clock> timeNow)
+    {
+        while (!keyedTimerQueue.empty() && keyedTimerQueue.begin()->first < timeNow)
+        {
+            auto it = keyedTimers.find(keyedTimerQueue.begin()->second);
+            auto& timer = it->second;
+            if (timer.task)
+            {
+                // Timer tasks are already in the queue's care, so they are admitted even if the queue is full
+                addCapacity(1, timer.task->getSize());
+                pushTask(std::move(timer.task), timer.priority);
+                if (timer.interval != std::chrono::steady_clock::duration::zero())
+                {
+                    // Throttled task starts a new interval
+                    moveKeyedTimer(timer, timeNow + timer.interval);
+                    continue;
+                }
+            }
+            keyedTimerQueue.erase(timer.position);
+            keyedTimers.erase(it);
+        }
+        if (keyedTimerQueue.empty())
+        {
+            // Registrations left in the parents just expire
+            keyedTimerRegistration = std::chrono::time_point<std::chrono::steady_clock>::max();
+            return std::chrono::time_point<std::chrono::steady_clock>::max();
+        }
+        const auto timeNext = keyedTimerQueue.begin()->first;
+        if (!parentLink)
+        {
+            return timeNext;
+        }
+        if (keyedTimerRegistration <= timeNow)
+        {
+            // Timer has been moved since it was registered, the parents have to wake us up again
+            keyedTimerRegistration = timeNext;
+            registerSubQueueTimer(timeNext);
+        }
+        return keyedTimerRegistration;
+    }
+
+    /// @brief add a debounce() or throttle() timer of a key that has none
+    /// @note this has to be called with taskQueueMutex locked
+    inline void addKeyedTimer(std::size_t key, std::chrono::time_point<std::chrono::steady_clock> time, KeyedTimer timer)
+    {
+        timer.position = keyedTimerQueue.emplace(time, key);
+        try
+        {
+            keyedTimers.emplace(key, std::move(timer));
+        }
+        catch (...)
+        {
+            keyedTimerQueue.erase(timer.position);
+            throw;
+        }
+        scheduleKeyedTimer(time);
+    }
+
+    /// @brief change the time of a debounce() or throttle() timer without allocating memory
+    /// @note this has to be called with taskQueueMutex locked
+    inline void moveKeyedTimer(KeyedTimer& timer, std::chrono::time_point<std::chrono::steady_clock> time)
+    {
+        auto node = keyedTimerQueue.extract(timer.position);
+        node.key() = time;
+        timer.position = keyedTimerQueue.insert(std::move(node));
+        scheduleKeyedTimer(time);
+    }
+
+    /// @brief wake up the queue thread (and parent queues) if a keyed timer expires before they would wake up anyway
+    /// @note a timer that has moved to a later time does not wake anyone up, the thread finds it when the old time expires
+    inline void scheduleKeyedTimer(std::chrono::time_point<std::chrono::steady_clock> time)
+    {
+        if (parentLink && time < keyedTimerRegistration)
+        {
+            keyedTimerRegistration = time;
+            registerSubQueueTimer(time);
+        }
+        if (time < nextDelayedTime.load(std::memory_order_acquire))
+        {
+            notifyQueueChange(0);
+        }
+    }
+
+    /// @brief move due delayed tasks to the task queue
+    /// @note this has to be called with taskQueueMutex locked or from the timer service
+    /// @param taskCount - number of tasks moved is added to it
+    /// @return time of the next delayed task or time_point::max() if there are none
+    inline std::chrono::time_point<std::chrono::steady_clock> updateDelayedTasks(std::chrono::time_point<std::chrono::steady_clock> timeNow, std::size_t& taskCount)
+    {
+        const std::lock_guard lock(delayedTaskOwner->mutex);
+        const auto moveTask = [this, &taskCount](std::shared_ptr<DelayedTask> task){
+            ++taskCount;
+            task->isLinked = false;
+            const auto priority = task->getPriority();
+            // Delayed tasks are already in the queue's care, so they are admitted even if the queue is full
+            auto taskNode = createTaskNode(std::move(task));
+            addCapacity(1, taskNode->getSize());
+            pushTask(std::move(taskNode), priority);
+        };
+        if (timingWheel)
+        {
+            timingWheel->advance(getTimerTick(timeNow), [&moveTask](DelayedTask* task){
+                moveTask(std::move(task->self));
+            });
+            return timingWheel->empty() ? std::chrono::time_point<std::chrono::steady_clock>::max() : getTimerTime(timingWheel->getNextTick());
+        }
+        // Like hrtimer slack in Linux - once we are awake, all the tasks in front which window has started go along
+        while (!delayedQueue.empty() && delayedQueue.begin()->getEarliestTime() < timeNow)
+        {
+            auto node = delayedQueue.extract(delayedQueue.begin());
+            moveTask(std::move(node.value().getTask()));
+        }
+        return delayedQueue.empty() ? std::chrono::time_point<std::chrono::steady_clock>::max() : delayedQueue.begin()->getTime();
+    }
+
+    /// @brief move due delayed tasks to the task queue on the timer service thread and wake up the queue threads
+    /// @return time at which the timer service has to call again
+    inline std::chrono::time_point<std::chrono::steady_clock> updateServiceTimer(std::chrono::time_point<std::chrono::steady_clock> timeNow)
+    {
+        std::size_t taskCount { 0 };
+        const auto timeNext = updateDelayedTasks(timeNow, taskCount);
+        if (taskCount != 0)
+        {
+            notifyQueueChange(taskCount);
+        }
+        return timeNext;
+    }
+
+    /// @brief link a delayed task in the ordered set or the timing wheel
+    /// @param tolerance - time after the given time by which the task has to be moved to the task queue
+    /// @return latest time at which the task is moved to the task queue (with the timing wheel the time is rounded up to a whole tick)
+    inline std::chrono::time_point<std::chrono::steady_clock> addDelayedTask(std::shared_ptr<DelayedTask> task,
+                                                                             std::chrono::time_point<std::chrono::steady_clock> time,
+                                                                             std::chrono::steady_clock::duration tolerance = std::chrono::steady_clock::duration::zero())
+    {
+        const std::lock_guard lock(delayedTaskOwner->mutex);
+        auto& ref = *task;
+        if (timingWheel)
+        {
+            auto tick = getTimerTick(time + timerResolution - std::chrono::steady_clock::duration(1));
+            const auto lastTick = getTimerTick(time + tolerance);
+            if (lastTick > tick)
+            {
+                // Pick the tick with the most trailing zeros within the window, so that tasks with overlapping windows meet in the same tick
+                const auto shift = findLastSet((tick - 1) ^ lastTick);
+                tick = lastTick >> shift << shift;
+            }
+            ref.self = std::move(task);
+            time = getTimerTime(timingWheel->insert(&ref, tick));
+        }
+        else
+        {
+            ref.position = delayedQueue.emplace(time + tolerance, time, std::move(task));
+            time += tolerance;
+        }
+        ref.isLinked = true;
+        return time;
+    }
+
+    /// @brief unlink a cancelled delayed task, which releases it right away
+    /// @note this has to be called with delayedTaskOwner's mutex locked
+    inline void removeDelayedTask(DelayedTask& task)
+    {
+        std::shared_ptr<DelayedTask> ptr;
+        auto time = std::chrono::time_point<std::chrono::steady_clock>::max();
+        if (timingWheel)
+        {
+            time = getTimerTime(task.getTick());
+            timingWheel->erase(&task);
+            ptr = std::move(task.self);
+        }
+        else
+        {
+            time = task.position->getTime();
+            ptr = std::move(delayedQueue.extract(task.position).value().getTask());
+        }
+        task.isLinked = false;
+        // The timer service finds nothing to move at the old time and just asks for the next one
+        if (!serviceTimer && time <= nextDelayedTime.load(std::memory_order_acquire))
+        {
+            // Queue thread might be waiting for this task, let it find the next one instead
+            notifyQueueChange(0);
+        }
+    }
+
+    /// @brief destroy all the delayed tasks without executing them
+    /// @note this has to be called with delayedTaskOwner's mutex locked
+    inline void clearDelayedTasks() noexcept
+    {
+        for (auto& wrapper : delayedQueue)
+        {
+            wrapper.getTask()->isLinked = false;
+        }
+        delayedQueue.clear();
+        if (timingWheel)
+        {
+            timingWheel->clear([](DelayedTask* task){
+                task->isLinked = false;
+                task->self.reset();
+            });
+        }
+    }
+
+    /// @brief get the number of whole timing wheel ticks that have passed since the queue was created up to given time
+    inline std::uint64_t getTimerTick(std::chrono::time_point<std::chrono::steady_clock> time) const noexcept
+    {
+        return time > timerOrigin ? static_cast<std::uint64_t>((time - timerOrigin) / timerResolution) : 0;
+    }
+
+    /// @brief get the time of a timing wheel tick (time_point::max() if it's out of range)
+    inline std::chrono::time_point<std::chrono::steady_clock> getTimerTime(std::uint64_t tick) const noexcept
+    {
+        const auto maxTick = static_cast<std::uint64_t>((std::chrono::time_point<std::chrono::steady_clock>::max() - timerOrigin) / timerResolution);
+        if (tick >= maxTick)
+        {
+            return std::chrono::time_point<std::chrono::steady_clock>::max();
+        }
+        return timerOrigin + timerResolution * static_cast<std::chrono::steady_clock::rep>(tick);
+    }
+
+    /// @brief schedule the next execution of a periodic task that has just been executed
+    inline void schedulePeriodicTask(PeriodicTask& task)
+    {
+        const std::lock_guard lock(taskQueueMutex);
+        if (task.position == periodicQueue.end())
+        {
+            // Dropped by cancelAll()
+            return;
+        }
+        if (task.getIsCanceled())
+        {
+            periodicQueue.erase(task.position);
+            task.position = periodicQueue.end();
+            return;
+        }
+        const auto timeNow = std::chrono::steady_clock::now();
+        const auto period = task.getPeriod();
+        switch (task.getPolicy())
+        {
+            case PeriodicPolicy::FixedRate:
+                task.time += period;
+                if (task.time <= timeNow)
+                {
+                    task.time += ((timeNow - task.time) / period + 1) * period;
+                }
+                break;
+            case PeriodicPolicy::FixedRateCatchUp:
+                task.time += period;
+                break;
+            case PeriodicPolicy::FixedDelay:
+                task.time = timeNow + period;
+                break;
+        }
+        movePeriodicTask(task, task.time);
+        registerSubQueueTimer(task.time);
+        if (task.time < nextDelayedTime.load(std::memory_order_acquire))
+        {
+            notifyQueueChange(0);
+        }
+    }
+
+    /// @brief change the time of a periodic task without allocating memory
+    /// @note this has to be called with taskQueueMutex locked
+    inline void movePeriodicTask(PeriodicTask& task, std::chrono::time_point<std::chrono::steady_clock> time)
+    {
+        auto node = periodicQueue.extract(task.position);
+        node.key() = time;
+        task.position = periodicQueue.insert(std::move(node));
+    }
+
+    inline void setThreadId(std::thread::id newThreadId)
+    {
+        const std::lock_guard lock(taskQueueMutex);
+        threadId = newThreadId;
+        for (auto& queue : getSubQueues())
+        {
+            queue->setThreadId(newThreadId);
+        }
+    }
+    
+    inline void setAcceptsTasks(bool newAcceptsTasks)
+    {
+        const std::lock_guard lock(taskQueueMutex);
+        acceptsTasks = newAcceptsTasks;
+        if (capacityEventCount && !newAcceptsTasks)
+        {
+            // Producers waiting for room in the queue have to give up
+            capacityEventCount->notifyAll();
+        }
+        for (auto& queue : getSubQueues())
+        {
+            queue->setAcceptsTasks(newAcceptsTasks);
+        }
+    }
+    
+    inline void notifyQueueChange(std::size_t taskCount = 1)
+    {
+        if (taskCount == 0)
+        {
+            scheduleChanged.store(true, std::memory_order_release);
+        }
+        else if (eventCount)
+        {
+            // This only costs an atomic load unless some thread is actually waiting for tasks
+            eventCount->notify(taskCount);
+            return;
+        }
+        const std::lock_guard lock(queueNotifyMutex);
+        if (queueNotifyCallback)
+        {
+            queueNotifyCallback(taskCount);
+        }
+    }
+    
+    inline void unregisterQueueChangeCallback()
+    {
+        const std::lock_guard lock(queueNotifyMutex);
+        queueNotifyCallback = nullptr;
+    }
+    
+    /// @brief take the next task of this queue according to the schedule
+    /// @param path - links of the sub-queues the task was taken through are appended to it
+    inline TaskNodePtr acquireNextTask(std::chrono::time_point<std::chrono::steady_clock> timeNow, std::vector<std::shared_ptr<SubQueueLink>>& path)
+    {
+        const std::lock_guard lock(taskQueueMutex);
+        if (getIsMainQueueNext())
+        {
+            if (auto next = popMainTask(timeNow))
+            {
+                mainPass += getPassIncrement(getChargedCost(mainCost), 1);
+                if (parentLink)
+                {
+                    recordWaitTime(*next, timeNow);
+                }
+                return next;
+            }
+        }
+        return acquireNextSubQueueTask(timeNow, path);
+    }
+
+    /// @brief take the next task from the sub-queue with the lowest pass, sub-queues without tasks are never visited
+    inline TaskNodePtr acquireNextSubQueueTask(std::chrono::time_point<std::chrono::steady_clock> timeNow, std::vector<std::shared_ptr<SubQueueLink>>& path)
+    {
+        while (!readySubQueues.empty())
+        {
+            std::pop_heap(readySubQueues.begin(), readySubQueues.end(), SubQueueLink::ComparePass{});
+            auto link = std::move(readySubQueues.back());
+            readySubQueues.pop_back();
+            virtualTime = link->pass;
+            auto queue = link->queue.lock();
+            if (!queue)
+            {
+                // Sub-queue has been destroyed
+                continue;
+            }
+            path.push_back(link);
+            bool isReady { false };
+            auto next = queue->acquireSubQueueTask(timeNow, path, isReady);
+            if (next)
+            {
+                // Sub-queue is charged up front with it's average task cost, so that it's position in the heap never changes
+                link->pass += getPassIncrement(getChargedCost(link->cost), link->weight);
+            }
+            else
+            {
+                path.pop_back();
+            }
+            if (isReady)
+            {
+                pushReadySubQueue(std::move(link));
+            }
+            if (next)
+            {
+                return next;
+            }
+        }
+        return nullptr;
+    }
+
+    /// @brief take the next task of a sub-queue that has been taken from parent's schedule
+    /// @param isReady - set to true if the sub-queue still has tasks and has to stay in parent's schedule
+    inline TaskNodePtr acquireSubQueueTask(std::chrono::time_point<std::chrono::steady_clock> timeNow,
+                                           std::vector<std::shared_ptr<SubQueueLink>>& path,
+                                           bool& isReady)
+    {
+        const std::lock_guard lock(taskQueueMutex);
+        updateSchedule(timeNow);
+        auto next = acquireNextTask(timeNow, path);
+        isReady = getHasReadyTasks();
+        if (!isReady)
+        {
+            parentLink->isReady.store(false, std::memory_order_relaxed);
+            // Pairs with the fence in scheduleSubQueue(), either we see new tasks or the producer sees the link released
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            isReady = getHasReadyTasks() && !parentLink->isReady.exchange(true, std::memory_order_acq_rel);
+        }
+        return next;
+    }
+
+    /// @brief move sub-queues that got tasks from the lock-free ready list to the schedule and check if main queue goes next
+    /// @note main queue and sub-queues are scheduled by stride scheduling - each of them has a pass that advances by the cost of
+    /// the tasks taken from it divided by it's weight, and the one with the lowest pass goes next
+    inline bool getIsMainQueueNext()
+    {
+        scheduleReadySubQueues();
+        return getHasMainTasks() && getIsMainPassNext();
+    }
+
+    /// @brief move sub-queues that got tasks from the lock-free ready list to the schedule
+    inline void scheduleReadySubQueues()
+    {
+        while (auto link = subQueueList->readyQueues.pop())
+        {
+            auto reference = std::move(link->readyReference);
+            // Sub-queue that has been idle does not get credit for the time it was idle
+            reference->pass = std::max(reference->pass, virtualTime);
+            pushReadySubQueue(std::move(reference));
+        }
+    }
+
+    /// @brief check if main queue's pass is not behind any of the ready sub-queues
+    inline bool getIsMainPassNext()
+    {
+        mainPass = std::max(mainPass, virtualTime);
+        if (readySubQueues.empty() || mainPass <= readySubQueues.front()->pass)
+        {
+            virtualTime = mainPass;
+            return true;
+        }
+        return false;
+    }
+
+    inline void pushReadySubQueue(std::shared_ptr<SubQueueLink> link)
+    {
+        readySubQueues.push_back(std::move(link));
+        std::push_heap(readySubQueues.begin(), readySubQueues.end(), SubQueueLink::ComparePass{});
+    }
+
+    /// @brief fixed-point scale of passes, so that a cheap task still advances the pass of a sub-queue with a large weight
+    static constexpr std::uint64_t PassScale { 1024 };
+
+    /// @brief get how much a pass advances for a task of given cost
+    static inline std::uint64_t getPassIncrement(std::uint64_t taskCost, std::size_t weight) noexcept
+    {
+        return std::max<std::uint64_t>(taskCost, 1) * PassScale / weight;
+    }
+
+    /// @brief get the cost a task of the main queue or a sub-queue is charged with
+    inline std::uint64_t getChargedCost(const std::atomic<std::uint64_t>& cost) const noexcept
+    {
+        return fairShareCost == FairShareCost::TaskCount ? 1 : cost.load(std::memory_order_relaxed);
+    }
+
+    /// @brief check if there are tasks in the task queue or any of the sub-queues
+    /// @note this has to be called by the consumer (with taskQueueMutex locked)
+    inline bool getHasReadyTasks() const noexcept
+    {
+        return getHasMainTasks() || !subQueueList->readyQueues.empty() || !readySubQueues.empty();
+    }
+
+    /// @brief check if there are tasks in the task queue of any priority
+    inline bool getHasMainTasks() const noexcept
+    {
+        return !deadlineQueue.empty() || !deadlineTasks.empty() || std::any_of(taskQueues.begin(), taskQueues.end(), [](const auto& queue){
+            return !queue.empty();
+        });
+    }
+
+    /// @brief take the next task of the main queue - the task with the earliest deadline if there is one, or the next task of the selected priority
+    /// @note this has to be called by the consumer (with taskQueueMutex locked)
+    inline TaskNodePtr popMainTask(std::chrono::time_point<std::chrono::steady_clock> timeNow)
+    {
+        if (auto next = popDeadlineTask())
+        {
+            return next;
+        }
+        return popTask(selectPriority(timeNow));
+    }
+
+    /// @brief take the task with the earliest deadline
+    /// @note tasks sent since the last call are moved from the lock-free deadline queue to the heap first, they get sequence numbers in the
+    /// order they were sent, so that tasks with equal deadlines are taken in that order; this has to be called by the consumer (with taskQueueMutex locked)
+    inline TaskNodePtr popDeadlineTask()
+    {
+        while (auto node = deadlineQueue.pop())
+        {
+            // Node is owned before it's pushed, so that it's released if the heap fails to grow
+            TaskNodePtr ptr(node);
+            deadlineTasks.push_back({ ptr->getDeadline(), deadlineSequence++, std::move(ptr) });
+            std::push_heap(deadlineTasks.begin(), deadlineTasks.end(), DeadlineTask::Compare{});
+        }
+        if (deadlineTasks.empty())
+        {
+            return nullptr;
+        }
+        std::pop_heap(deadlineTasks.begin(), deadlineTasks.end(), DeadlineTask::Compare{});
+        auto next = std::move(deadlineTasks.back().node);
+        deadlineTasks.pop_back();
+        releaseCapacity(*next);
+        return next;
+    }
+
+    /// @brief pick the priority level the next tasks are taken from
+    /// @note levels are taken in order of priority, except a level that has been passed over for longer than priorityAgingInterval
+    /// goes first, so that lower priority tasks are not starved; this has to be called by the consumer (with taskQueueMutex locked)
+    inline Priority selectPriority(std::chrono::time_point<std::chrono::steady_clock> timeNow) noexcept
+    {
+        // Tasks that are left over on shutdown are taken strictly in order of priority
+        const auto isAging = timeNow != std::chrono::time_point<std::chrono::steady_clock>::min();
+        auto selected = Priority::Normal;
+        bool isSelected { false };
+        for (std::size_t level = 0; level < taskQueues.size(); ++level)
+        {
+            auto& waitStart = priorityWaitStart[level];
+            if (taskQueues[level].empty())
+            {
+                waitStart = std::chrono::time_point<std::chrono::steady_clock>::max();
+                continue;
+            }
+            if (isAging && waitStart == std::chrono::time_point<std::chrono::steady_clock>::max())
+            {
+                waitStart = timeNow;
+            }
+            const auto isAged = isAging && timeNow > waitStart && std::chrono::duration_cast<std::chrono::microseconds>(timeNow - waitStart) >= priorityAgingInterval;
+            if (!isSelected || isAged)
+            {
+                selected = static_cast<Priority>(level);
+                isSelected = true;
+            }
+        }
+        // Selected level starts waiting anew once it's passed over again
+        priorityWaitStart[static_cast<std::size_t>(selected)] = std::chrono::time_point<std::chrono::steady_clock>::max();
+        return selected;
+    }
+
+    /// @brief check if selectPriority() would pick given level if it had tasks - no level of a higher priority has tasks and no level
+    /// of a lower priority is due for aging
+    /// @note lower levels with tasks start waiting from now if they were not waiting yet, so that they age while the given level is
+    /// passed tasks directly; this has to be called by the consumer (with taskQueueMutex locked)
+    inline bool getIsPriorityNext(Priority priority) noexcept
+    {
+        const auto selectedLevel = static_cast<std::size_t>(priority);
+        auto timeNow = std::chrono::time_point<std::chrono::steady_clock>::min();
+        for (std::size_t level = 0; level < taskQueues.size(); ++level)
+        {
+            if (level == selectedLevel || taskQueues[level].empty())
+            {
+                continue;
+            }
+            if (level < selectedLevel)
+            {
+                return false;
+            }
+            if (timeNow == std::chrono::time_point<std::chrono::steady_clock>::min())
+            {
+                // Clock is only read if there are tasks of a lower priority
+                timeNow = std::chrono::steady_clock::now();
+            }
+            auto& waitStart = priorityWaitStart[level];
+            if (waitStart == std::chrono::time_point<std::chrono::steady_clock>::max())
+            {
+                waitStart = timeNow;
+            }
+            else if (timeNow > waitStart && std::chrono::duration_cast<std::chrono::microseconds>(timeNow - waitStart) >= priorityAgingInterval)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// @brief take up to maxCount tasks from the main task queue in one go, or a single task from a sub-queue if it's their turn
+    /// @param timeNow - current time (this is also the time sub-queue tasks stop waiting)
+    /// @return true if the batch is not empty
+    inline bool acquireNextTasks(TaskBatch& batch, std::size_t maxCount, std::chrono::time_point<std::chrono::steady_clock> timeNow)
+    {
+        if (batch.tasks.getSize() != 0)
+        {
+            // Tasks left over from the previous batch go first, they might be of a different priority than the tasks in the queue
+            return true;
+        }
+        const std::lock_guard lock(taskQueueMutex);
+        batch.cancelCount = cancelCount.load(std::memory_order_relaxed);
+        batch.path.clear();
+        batch.priority = Priority::Normal;
+        batch.isDeadlineOrdered = false;
+        if (!getIsMainQueueNext())
+        {
+            // Sub-queue tasks are taken one at a time and only into an empty batch, so that tasks of a sub-queue destroyed
+            // by a preceding task are never executed
+            if (auto next = acquireNextSubQueueTask(timeNow, batch.path))
+            {
+                batch.tasks.append(std::move(next));
+                return true;
+            }
+        }
+        if (auto next = popDeadlineTask())
+        {
+            // Tasks with deadlines are taken one at a time, so that a task with an earlier deadline sent in the meantime goes next
+            batch.isDeadlineOrdered = true;
+            batch.tasks.append(std::move(next));
+            mainPass += getPassIncrement(getChargedCost(mainCost), 1);
+            return true;
+        }
+        batch.priority = selectPriority(timeNow);
+        maxCount = std::min(maxCount, getMaxAcquireCount());
+        std::size_t count { 0 };
+        for (; count < maxCount; ++count)
+        {
+            auto next = popTask(batch.priority);
+            if (!next)
+            {
+                break;
+            }
+            batch.tasks.append(std::move(next));
+        }
+        if (loadSheddingAge.count() != 0)
+        {
+            // The most recently sent task of the batch has waited the least, so the tasks are old if even this one is
+            const auto delay = count != 0 ? std::max(timeNow - batch.tasks.getLast()->getSendTime(), std::chrono::steady_clock::duration::zero()) : std::chrono::steady_clock::duration::zero();
+            queueDelay.store(static_cast<std::uint64_t>(std::chrono::nanoseconds(delay).count()), std::memory_order_relaxed);
+        }
+        mainPass += getPassIncrement(getChargedCost(mainCost), 1) * count;
+        return batch.tasks.getSize() != 0;
+    }
     
-    inline void notifyQueueChange()
+    /// @brief execute tasks back to back until the batch is exhausted or it's budget is spent
+    /// @param timeStart - time the batch was acquired
+    inline void runBatch(TaskBatch& batch, std::chrono::time_point<std::chrono::steady_clock> timeStart)
     {
-        const std::lock_guard lock(queueNotifyMutex);
-        if (queueNotifyCallback)
+        const auto deadline = timeStart + maxBatchDuration;
+        std::size_t executedCount { 0 };
+        StintCounters stint;
+        auto stintStart = timeStart;
+        auto timeNow = timeStart;
+        while (auto next = batch.tasks.popFront())
         {
-            queueNotifyCallback();
+            if (timeNow >= next->getExpiryTime())
+            {
+                // Nobody is waiting for the result any more, destroying the task cancels it
+                next.reset();
+                ++stint.expiredCount;
+            }
+            else if (next->getIsSheddable() && batch.path.empty() && !batch.isDeadlineOrdered && getIsShed(batch.priority))
+            {
+                // Queue is overloaded, destroying the task cancels it
+                next.reset();
+                ++stint.shedCount;
+            }
+            else
+            {
+                try
+                {
+                    next->execute();
+                }
+                catch (...)
+                {
+                    // We can't do nothing as nobody is listening, but we don't want the thread to explode
+                }
+                const auto taskDeadline = next->getDeadline();
+                next.reset();
+                timeNow = std::chrono::steady_clock::now();
+                ++stint.executedCount;
+                if (timeNow > taskDeadline)
+                {
+                    ++stint.missCount;
+                }
+            }
+            if (batch.cancelCount != cancelCount.load(std::memory_order_relaxed))
+            {
+                // cancelAll() was called while the batch was running
+                batch.tasks.clear();
+                break;
+            }
+            if (++executedCount >= maxBatchSize || timeNow >= deadline)
+            {
+                // Budget is spent, whatever is left in the batch runs after delayed tasks have been looked at
+                break;
+            }
+            if (batch.tasks.getSize() == 0)
+            {
+                recordExecution(batch, timeNow - stintStart, stint);
+                stintStart = timeNow;
+                stint = {};
+                if (!acquireNextTasks(batch, maxBatchSize - executedCount, timeNow))
+                {
+                    break;
+                }
+            }
         }
+        recordExecution(batch, timeNow - stintStart, stint);
     }
-    
-    inline void unregisterQueueChangeCallback()
+
+    /// @brief counters of tasks taken from the same queue and executed back to back
+    struct StintCounters
     {
-        const std::lock_guard lock(queueNotifyMutex);
-        queueNotifyCallback = nullptr;
+        /// @brief number of tasks executed
+        std::size_t executedCount { 0 };
+        /// @brief number of the executed tasks that finished after their deadline
+        std::size_t missCount { 0 };
+        /// @brief number of tasks dropped because they expired before they were started
+        std::size_t expiredCount { 0 };
+        /// @brief number of sheddable tasks dropped because the queue was overloaded
+        std::size_t shedCount { 0 };
+    };
+
+    /// @brief update task cost estimates and statistics of the queues the tasks of a batch were taken from
+    inline void recordExecution(const TaskBatch& batch, std::chrono::nanoseconds elapsed, const StintCounters& stint)
+    {
+        if (stint.executedCount == 0 && stint.expiredCount == 0 && stint.shedCount == 0)
+        {
+            return;
+        }
+        if (stint.executedCount != 0)
+        {
+            const auto taskCost = static_cast<std::uint64_t>(elapsed.count()) / stint.executedCount;
+            for (const auto& link : batch.path)
+            {
+                updateCost(link->cost, taskCost);
+            }
+        }
+        if (batch.path.empty())
+        {
+            addExecution(elapsed, stint);
+        }
+        else if (auto queue = batch.path.back()->queue.lock())
+        {
+            queue->addExecution(elapsed, stint);
+        }
+    }
+
+    inline void addExecution(std::chrono::nanoseconds elapsed, const StintCounters& stint) noexcept
+    {
+        if (stint.executedCount != 0)
+        {
+            updateCost(mainCost, static_cast<std::uint64_t>(elapsed.count()) / stint.executedCount);
+            executedCount.fetch_add(stint.executedCount, std::memory_order_relaxed);
+            executionTime.fetch_add(static_cast<std::uint64_t>(elapsed.count()), std::memory_order_relaxed);
+        }
+        if (stint.missCount != 0)
+        {
+            deadlineMissCount.fetch_add(stint.missCount, std::memory_order_relaxed);
+        }
+        if (stint.expiredCount != 0)
+        {
+            expiredCount.fetch_add(stint.expiredCount, std::memory_order_relaxed);
+        }
+        if (stint.shedCount != 0)
+        {
+            shedCount.fetch_add(stint.shedCount, std::memory_order_relaxed);
+        }
+    }
+
+    /// @brief record how long a sub-queue task has waited to be taken from the queue
+    /// @note this has to be called by the consumer (with taskQueueMutex locked)
+    inline void recordWaitTime(const TaskNode& node, std::chrono::time_point<std::chrono::steady_clock> timeNow) noexcept
+    {
+        const auto waitTime = static_cast<std::uint64_t>(std::chrono::nanoseconds(std::max(timeNow - node.getSendTime(), std::chrono::steady_clock::duration::zero())).count());
+        totalWaitTime.fetch_add(waitTime, std::memory_order_relaxed);
+        if (waitTime > maxWaitTime.load(std::memory_order_relaxed))
+        {
+            maxWaitTime.store(waitTime, std::memory_order_relaxed);
+        }
+    }
+
+    /// @brief update exponential moving average of task cost (weight of the new sample is 1/8)
+    static inline void updateCost(std::atomic<std::uint64_t>& cost, std::uint64_t taskCost) noexcept
+    {
+        const auto oldCost = cost.load(std::memory_order_relaxed);
+        cost.store(oldCost - oldCost / 8 + taskCost / 8, std::memory_order_relaxed);
     }
     
-    inline std::shared_ptr<Task> acquireNextTask()
+    inline void releaseSubQueues()
     {
         const std::lock_guard lock(taskQueueMutex);
-        // First process main queue
-        if (!taskQueue.empty())
+        // If a parent queue is being destroyed we want to make sure nobody tries to call it back after destruction
+        for (auto& queue : getSubQueues())
         {
-            auto next = std::move(taskQueue.front());
-            taskQueue.pop();
-            return next;
+            queue->unregisterQueueChangeCallback();
+        }
+    }
+
+    inline void runLoop(const Thread::StopToken& stopToken)
+    {
+        TaskBatch batch;
+        // Only one thread can sleep on a precise timer of the event count
+        IdleState idleState { idlePolicy, maxSpinDuration, getHasSingleConsumer() ? timerPrecision : TimerPrecision::Default, timerSpinDuration };
+        if (getHasSingleConsumer())
+        {
+            // Tasks this thread sends to it's own queue can skip the shared queue
+            getRunLoopContext() = { this, &batch };
         }
-        // Then take sub-queues in creation order
-        for (auto& q : subQueues)
+        while (!stopToken.getIsStopping())
         {
-            if (auto queue = q.lock())
+            // Move delayed tasks to main queue
+            const auto timeNow = std::chrono::steady_clock::now();
+            auto nextTaskTime = updateSchedule(timeNow);
+            if (acquireNextTasks(batch, maxBatchSize, timeNow))
             {
-                auto next = queue->acquireNextTask();
-                if (next)
-                {
-                    return next;
-                }
+                runBatch(batch, timeNow);
+                continue;
+            }
+            if (runIdleTask(timeNow))
+            {
+                continue;
+            }
+            // Announce that we are about to wait and check once more, so that a task pushed in the meantime is not missed
+            const auto waitKey = eventCount->prepareWait();
+            if (stopToken.getIsStopping() || !getAcceptsTasks() || getHasPendingTasks())
+            {
+                eventCount->cancelWait();
+            }
+            else
+            {
+                idleState.wait(*eventCount, waitKey, timeNow, nextTaskTime);
             }
         }
-        return nullptr;
+        getRunLoopContext() = {};
+        setAcceptsTasks(false);
+        runLeftovers(batch);
     }
-    
-    inline void clearDeadSubQueues()
+
+    inline void runLeftovers(TaskBatch& batch)
+    {
+        /// @note Delayed tasks are implicitly canceled by this point as their deadlines hadn't arrived
+        // Process tasks that were already taken from the queue
+        if (batch.cancelCount != cancelCount.load(std::memory_order_relaxed))
+        {
+            batch.tasks.clear();
+        }
+        while (auto next = batch.tasks.popFront())
+        {
+            if (std::chrono::steady_clock::now() < next->getExpiryTime())
+            {
+                next->execute();
+            }
+        }
+        // Process any leftover tasks (expired tasks are dropped)
+        std::vector<std::shared_ptr<SubQueueLink>> path;
+        while (auto next = acquireNextTask(std::chrono::time_point<std::chrono::steady_clock>::min(), path))
+        {
+            if (std::chrono::steady_clock::now() < next->getExpiryTime())
+            {
+                next->execute();
+            }
+        }
+    }
+
+    /// @brief execute the next idle task if there is one, it gets a time slice that starts at given time
+    /// @return true if a task was executed
+    inline bool runIdleTask(std::chrono::time_point<std::chrono::steady_clock> timeNow)
+    {
+        TaskNodePtr next;
+        {
+            const std::lock_guard lock(taskQueueMutex);
+            next = TaskNodePtr(idleTasks->tasks.pop());
+        }
+        if (!next)
+        {
+            return false;
+        }
+        IdleDeadline deadline { *this, timeNow + idleTimeSlice };
+        getIdleDeadline() = &deadline;
+        try
+        {
+            next->execute();
+        }
+        catch (...)
+        {
+            // We can't do nothing as nobody is listening, but we don't want the thread to explode
+            deadline.isContinued = false;
+        }
+        getIdleDeadline() = nullptr;
+        if (deadline.isContinued && getAcceptsTasks())
+        {
+            // Task has more work to do, it goes after the other idle tasks, so that they get their turn too
+            idleTasks->tasks.push(next.release());
+        }
+        return true;
+    }
+
+    /// @brief check if tasks have been sent or delayed tasks have become due since the queue has run out of tasks
+    /// @note this can be called from any thread, while the queue thread is executing an idle task
+    inline bool getHasNewTasks(std::chrono::time_point<std::chrono::steady_clock> timeNow) const noexcept
+    {
+        return scheduleChanged.load(std::memory_order_acquire) ||
+            timeNow >= nextDelayedTime.load(std::memory_order_acquire) ||
+            !deadlineQueue.drained() ||
+            !subQueueList->readyQueues.drained() ||
+            !std::all_of(taskQueues.begin(), taskQueues.end(), [](const auto& queue){
+                return queue.drained();
+            });
+    }
+
+    /// @brief check if there are any tasks or schedule changes waiting to be processed in this queue or it's sub-queues
+    inline bool getHasPendingTasks()
     {
+        if (scheduleChanged.load(std::memory_order_acquire))
+        {
+            return true;
+        }
+        if (!idleTasks->tasks.drained())
+        {
+            return true;
+        }
         const std::lock_guard lock(taskQueueMutex);
-        auto it = subQueues.begin();
-        while (it != subQueues.end())
+        return getHasReadyTasks();
+    }
+
+    /// @brief send a task node, either by appending it to the batch that's being executed or by linking it in the task queue
+    /// @param waitTime - time until which to wait for room in the queue (time_point::min() - don't wait, time_point::max() - wait as long as it takes)
+    /// @return false if there was no room in the queue
+    inline bool sendNode(TaskNodePtr node, Priority priority, std::chrono::time_point<std::chrono::steady_clock> waitTime)
+    {
+        if (!getAcceptsTasks())
+        {
+            throw std::runtime_error("Task queue is not accepting any tasks, the thread has been signaled for stopping");
+        }
+        if (auto batch = getLocalBatch(priority))
+        {
+            // We are on the queue thread and every task sent before has already been taken from the shared queue,
+            // so the task can go straight to the end of the batch that's being executed without any atomics or wake-ups
+            batch->tasks.append(std::move(node));
+            return true;
+        }
+        if (!acquireCapacity(1, node->getSize(), waitTime))
+        {
+            return false;
+        }
+        pushTask(std::move(node), priority);
+        notifyQueueChange();
+        return true;
+    }
+
+    /// @brief take room for tasks in the queue, waiting for the consumer to make room if the queue is full
+    /// @note a single task (or batch) that exceeds the capacity on it's own is admitted once the queue is empty, tasks sent from the queue
+    /// thread are always admitted as it would deadlock waiting for itself
+    /// @param waitTime - time until which to wait (time_point::min() - don't wait, time_point::max() - wait as long as it takes)
+    /// @return false if there was no room before waitTime
+    inline bool acquireCapacity(std::size_t count, std::size_t size, std::chrono::time_point<std::chrono::steady_clock> waitTime)
+    {
+        if (!capacityEventCount)
+        {
+            addCapacity(count, size);
+            return true;
+        }
+        if (getIsSameThread())
+        {
+            addCapacity(count, size);
+            return true;
+        }
+        while (!tryAcquireCapacity(count, size))
         {
-            if (auto queue = it->lock())
+            if (waitTime == std::chrono::time_point<std::chrono::steady_clock>::min() || std::chrono::steady_clock::now() >= waitTime)
+            {
+                return false;
+            }
+            // Announce that we are about to wait and check once more, so that room made in the meantime is not missed
+            const auto waitKey = capacityEventCount->prepareWait();
+            if (!getAcceptsTasks())
+            {
+                capacityEventCount->cancelWait();
+                throw std::runtime_error("Task queue is not accepting any tasks, the thread has been signaled for stopping");
+            }
+            if (tryAcquireCapacity(count, size))
+            {
+                capacityEventCount->cancelWait();
+                return true;
+            }
+            if (waitTime == std::chrono::time_point<std::chrono::steady_clock>::max())
             {
-                queue->clearDeadSubQueues();
-                ++it;
+                capacityEventCount->wait(waitKey);
             }
             else
             {
-                // Remove sub-queue that might be destroyed by it's owner
-                it = subQueues.erase(it);
+                capacityEventCount->waitUntil(waitKey, waitTime);
+            }
+            if (!getAcceptsTasks())
+            {
+                throw std::runtime_error("Task queue is not accepting any tasks, the thread has been signaled for stopping");
             }
         }
+        return true;
     }
-    
-    inline void releaseSubQueues()
+
+    /// @brief take room for tasks in the queue if there is enough of it
+    inline bool tryAcquireCapacity(std::size_t count, std::size_t size) noexcept
     {
-        const std::lock_guard lock(taskQueueMutex);
-        // If a parent queue is being destroyed we want to make sure nobody tries to call it back after destruction
-        for (auto& q : subQueues)
+        if (!tryAddLimited(pendingCount, count, capacity))
         {
-            if (auto queue = q.lock())
+            return false;
+        }
+        if (!tryAddLimited(pendingSize, size, capacitySize))
+        {
+            pendingCount.fetch_sub(count, std::memory_order_acq_rel);
+            // Somebody might have given up on the count we held for a moment
+            capacityEventCount->notifyAll();
+            return false;
+        }
+        return true;
+    }
+
+    /// @brief add to a counter unless it would exceed the limit (a counter at 0 accepts any amount, so that oversized tasks are not stuck)
+    static inline bool tryAddLimited(std::atomic<std::size_t>& counter, std::size_t amount, std::size_t limit) noexcept
+    {
+        auto current = counter.load(std::memory_order_relaxed);
+        do
+        {
+            if (limit != 0 && current != 0 && current + amount > limit)
             {
-                queue->unregisterQueueChangeCallback();
+                return false;
             }
         }
+        while (!counter.compare_exchange_weak(current, current + amount, std::memory_order_acq_rel, std::memory_order_relaxed));
+        return true;
     }
 
-    inline void runLoop(const Thread::StopToken& stopToken)
+    /// @brief take room for tasks in the queue even if it's full
+    inline void addCapacity(std::size_t count, std::size_t size) noexcept
     {
-        while (!stopToken.getIsStopping())
+        if (isCountingTasks)
         {
-            std::unique_lock lock { waitMutex };
-            // Move delayed tasks to main queue
-            const auto timeNow = std::chrono::steady_clock::now();
-            auto nextTaskTime = enqueueDelayedTasks(timeNow);
-            auto nextTask = acquireNextTask();
-            if (nextTask)
+            pendingCount.fetch_add(count, std::memory_order_acq_rel);
+            pendingSize.fetch_add(size, std::memory_order_acq_rel);
+        }
+    }
+
+    /// @brief give back the room of a task that has left the queue and wake up producers waiting for it
+    inline void releaseCapacity(const TaskNode& node) noexcept
+    {
+        if (isCountingTasks)
+        {
+            pendingCount.fetch_sub(1, std::memory_order_acq_rel);
+            pendingSize.fetch_sub(node.getSize(), std::memory_order_acq_rel);
+        }
+        if (capacityEventCount)
+        {
+            // This only costs an atomic load unless some producer is actually waiting
+            capacityEventCount->notifyAll();
+        }
+    }
+
+    /// @brief link a task at the end of the task queue of it's priority, this is lock-free and can be called from any thread
+    /// @note room for the task has to be taken with acquireCapacity() or addCapacity() first
+    inline void pushTask(TaskNodePtr node, Priority priority = Priority::Normal) noexcept
+    {
+        if (getIsMeasuringWaitTime())
+        {
+            node->setSendTime(std::chrono::steady_clock::now());
+        }
+        getTaskQueue(priority).push(node.release());
+        scheduleInParent();
+    }
+
+    /// @brief link a chain of tasks at the end of the task queue and notify the thread once
+    inline void pushTasks(TaskChain& chain) noexcept
+    {
+        if (const auto taskCount = chain.getSize())
+        {
+            if (getIsMeasuringWaitTime())
             {
-                lock.unlock();
-                try
-                {
-                    nextTask->execute();
-                }
-                catch (...)
+                const auto timeNow = std::chrono::steady_clock::now();
+                for (auto node = chain.getFirst(); node; node = node != chain.getLast() ? IntrusiveMpscQueue<TaskNode>::getNext(node) : nullptr)
                 {
-                    // We can't do nothing as nobody is listening, but we don't want the thread to explode
+                    node->setSendTime(timeNow);
                 }
-                lock.lock();
             }
-            else if (nextTaskTime != timeNow)
+            getTaskQueue(Priority::Normal).push(chain.getFirst(), chain.getLast());
+            chain.release();
+            scheduleInParent();
+            notifyQueueChange(taskCount);
+        }
+    }
+
+    /// @brief check if tasks have to be stamped with the time they were sent
+    inline bool getIsMeasuringWaitTime() const noexcept
+    {
+        return parentLink || loadSheddingAge.count() != 0;
+    }
+
+    /// @brief get the number of priority levels (lowest first) of which sheddable tasks are shed right now
+    inline std::size_t getShedLevelCount() const noexcept
+    {
+        std::size_t levelCount { 0 };
+        if (loadSheddingDepth != 0)
+        {
+            levelCount = getOverloadLevelCount(pendingCount.load(std::memory_order_relaxed), loadSheddingDepth);
+        }
+        if (loadSheddingAge.count() != 0)
+        {
+            const auto delay = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::nanoseconds(queueDelay.load(std::memory_order_relaxed)));
+            levelCount = std::max(levelCount, getOverloadLevelCount(static_cast<std::uint64_t>(delay.count()), static_cast<std::uint64_t>(loadSheddingAge.count())));
+        }
+        return levelCount;
+    }
+
+    /// @brief check if sheddable tasks of given priority are shed right now
+    inline bool getIsShed(Priority priority) const noexcept
+    {
+        return static_cast<std::size_t>(priority) + getShedLevelCount() >= PriorityCount;
+    }
+
+    /// @brief get how many times the threshold has been crossed, doubling it each time (up to the number of priority levels)
+    static inline std::size_t getOverloadLevelCount(std::uint64_t value, std::uint64_t threshold) noexcept
+    {
+        std::size_t levelCount { 0 };
+        for (; levelCount < PriorityCount && value >= threshold; ++levelCount)
+        {
+            if (threshold > std::numeric_limits<std::uint64_t>::max() / 2)
             {
-                // There are no tasks to process, but delayedQueue had some tasks, we can wait till delay expires
-                queueWait.wait_until(lock, nextTaskTime);
+                return levelCount + 1;
             }
-            else if (getAcceptsTasks())
+            threshold *= 2;
+        }
+        return levelCount;
+    }
+
+    /// @brief put this sub-queue in it's parent's ready list after a task has been pushed
+    inline void scheduleInParent() noexcept
+    {
+        if (parentLink)
+        {
+            scheduleSubQueue(parentLink.get());
+        }
+    }
+
+    /// @brief let the parent queues know when the delayed task of this sub-queue is due
+    inline void registerSubQueueTimer(std::chrono::time_point<std::chrono::steady_clock> time)
+    {
+        for (auto link = parentLink.get(); link; link = link->parentList->ownerLink.get())
+        {
+            const std::lock_guard lock(link->parentList->mutex);
+            link->parentList->timers.emplace(time, link->weak_from_this());
+        }
+    }
+
+    /// @brief get all the sub-queues that are still alive
+    inline std::vector<std::shared_ptr<TaskQueue>> getSubQueues() const
+    {
+        std::vector<std::shared_ptr<TaskQueue>> queues;
+        const std::lock_guard lock(subQueueList->mutex);
+        queues.reserve(subQueueList->queues.size());
+        for (const auto& q : subQueueList->queues)
+        {
+            if (auto queue = q.lock())
             {
-                // We wait for a new task to be pushed on any of the queues
-                queueWait.wait(lock);
+                queues.push_back(std::move(queue));
             }
-            clearDeadSubQueues();
         }
-        setAcceptsTasks(false);
-        runLeftovers();
+        return queues;
     }
 
-    inline void runLeftovers()
+    /// @brief create a task queue node for a task that's shared with a TaskHandle
+    inline TaskNodePtr createTaskNode(std::shared_ptr<Task> task)
     {
-        std::unique_lock lock { waitMutex };
-        /// @note Delayed tasks are implicitly canceled by this point as their deadlines hadn't arrived
-        // Process any leftover tasks
-        while (auto next = acquireNextTask())
+        return TaskNode::create(memoryResource, [task = std::move(task)](){
+            task->execute();
+        });
+    }
+
+    /// @brief unlink a task from the front of the task queue of given priority
+    /// @note only one consumer can pop tasks at a time, so this has to be called with taskQueueMutex locked (or from destructor)
+    inline TaskNodePtr popTask(Priority priority) noexcept
+    {
+        auto next = TaskNodePtr(getTaskQueue(priority).pop());
+        if (next)
         {
-            lock.unlock();
-            next->execute();
-            lock.lock();
+            releaseCapacity(*next);
+        }
+        return next;
+    }
+
+    /// @brief destroy all the tasks in the task queue without executing them
+    /// @note this has to be called with taskQueueMutex locked (or from destructor)
+    inline void clearTasks() noexcept
+    {
+        for (auto& queue : taskQueues)
+        {
+            while (auto node = TaskNodePtr(queue.pop()))
+            {
+                releaseCapacity(*node);
+            }
+        }
+        while (auto node = TaskNodePtr(deadlineQueue.pop()))
+        {
+            releaseCapacity(*node);
         }
+        for (auto& task : deadlineTasks)
+        {
+            releaseCapacity(*task.node);
+        }
+        deadlineTasks.clear();
+    }
+
+    inline IntrusiveMpscQueue<TaskNode>& getTaskQueue(Priority priority) noexcept
+    {
+        return taskQueues[static_cast<std::size_t>(priority)];
+    }
+
+    /// @brief check if tasks are executed by a single thread
+    inline bool getHasSingleConsumer() const noexcept
+    {
+        return hasSingleConsumer;
+    }
+
+    /// @brief get the maximum number of tasks a single thread can take from the task queue at once
+    inline std::size_t getMaxAcquireCount() const noexcept
+    {
+        // Tasks of a multi-threaded queue are taken one by one, so that they are spread across all the workers
+        return getHasSingleConsumer() ? maxBatchSize : 1;
     }
 
     inline void notifyQueueOne()
     {
-        queueWait.notify_one();
+        eventCount->notify(1);
     }
 
     inline void notifyQueueAll()
     {
-        queueWait.notify_all();
+        eventCount->notifyAll();
     }
     
 private:
+    /// @brief event count shared by the queue and it's sub-queues (nullptr if queue is driven by a custom notify callback)
+    std::shared_ptr<EventCount> eventCount;
+    /// @brief tasks sent with sendIdle() (shared with the root queue if this is a sub-queue)
+    std::shared_ptr<IdleTaskList> idleTasks;
+    std::chrono::microseconds idleTimeSlice;
     std::thread::id threadId { std::this_thread::get_id() };
     std::atomic_bool acceptsTasks { true };
-    std::queue<std::shared_ptr<Task>> taskQueue;
-    std::multiset<std::unique_ptr<DelayedTaskWrapper>> delayedQueue;
-    std::vector<std::weak_ptr<TaskQueue>> subQueues;
-    std::function<void(void)> queueNotifyCallback { nullptr };
+    std::pmr::memory_resource* memoryResource;
+    std::size_t maxBatchSize;
+    std::chrono::microseconds maxBatchDuration;
+    IdlePolicy idlePolicy;
+    std::chrono::microseconds maxSpinDuration;
+    TimerPrecision timerPrecision;
+    std::chrono::microseconds timerSpinDuration;
+    std::chrono::microseconds priorityAgingInterval;
+    /// @brief task queue of each priority level, highest priority first
+    std::array<IntrusiveMpscQueue<TaskNode>, PriorityCount> taskQueues;
+    /// @brief time since a non-empty priority level has been passed over (only accessed by the consumer)
+    std::array<std::chrono::time_point<std::chrono::steady_clock>, PriorityCount> priorityWaitStart {
+        std::chrono::time_point<std::chrono::steady_clock>::max(),
+        std::chrono::time_point<std::chrono::steady_clock>::max(),
+        std::chrono::time_point<std::chrono::steady_clock>::max()
+    };
+    SchedulingMode schedulingMode;
+    FairShareCost fairShareCost;
+    /// @brief tasks sent with a deadline that haven't been moved to the heap yet (only used with SchedulingMode::EarliestDeadlineFirst)
+    IntrusiveMpscQueue<TaskNode> deadlineQueue;
+    /// @brief min-heap of tasks sent with a deadline (only accessed by the consumer)
+    std::pmr::vector<DeadlineTask> deadlineTasks;
+    /// @brief sequence number of the next task moved to the deadline heap
+    std::uint64_t deadlineSequence { 0 };
+    std::atomic_bool scheduleChanged { false };
+    std::atomic<std::chrono::time_point<std::chrono::steady_clock>> nextDelayedTime { std::chrono::time_point<std::chrono::steady_clock>::max() };
+    std::atomic<std::size_t> cancelCount { 0 };
+    /// @brief guards delayedQueue and timingWheel, it's shared with the delayed tasks
+    std::shared_ptr<DelayedTaskOwner> delayedTaskOwner;
+    DelayedTaskQueue delayedQueue;
+    /// @brief delayed tasks if the queue uses TimerBackend::TimingWheel (delayedQueue is not used then)
+    std::unique_ptr<TimingWheel<DelayedTask>> timingWheel;
+    /// @brief timer of the queue in it's timer service (nullptr if queue threads move delayed tasks on their own)
+    std::unique_ptr<TimerService::Timer> serviceTimer;
+    /// @brief time of timing wheel's tick 0
+    std::chrono::time_point<std::chrono::steady_clock> timerOrigin;
+    std::chrono::steady_clock::duration timerResolution;
+    /// @brief keys of debounce() and throttle() timers ordered by their time
+    KeyedTimerQueue keyedTimerQueue;
+    std::pmr::unordered_map<std::size_t, KeyedTimer> keyedTimers;
+    /// @brief earliest time registered in the parents for the keyed timers of this sub-queue (time_point::max() if there is none)
+    std::chrono::time_point<std::chrono::steady_clock> keyedTimerRegistration { std::chrono::time_point<std::chrono::steady_clock>::max() };
+    /// @brief tasks sent with sendPeriodic() ordered by their time (tasks that are queued or running wait at time_point::max())
+    PeriodicTimerQueue periodicQueue;
+    std::size_t capacity;
+    std::size_t capacitySize;
+    /// @brief number and estimated size of tasks in the task queue (only counted if the queue has a capacity)
+    std::atomic<std::size_t> pendingCount { 0 };
+    std::atomic<std::size_t> pendingSize { 0 };
+    /// @brief event count producers wait on while the queue is full (nullptr if the queue has no capacity)
+    std::unique_ptr<EventCount> capacityEventCount;
+    std::size_t loadSheddingDepth;
+    std::chrono::microseconds loadSheddingAge;
+    /// @brief set if pendingCount and pendingSize are kept up to date
+    bool isCountingTasks;
+    const bool hasSingleConsumer;
+    /// @brief wait time of the most recently sent task of the last batch in nanoseconds, 0 if the queue was empty (only measured if loadSheddingAge is set)
+    std::atomic<std::uint64_t> queueDelay { 0 };
+    std::atomic<std::size_t> shedCount { 0 };
+    std::atomic<std::size_t> rejectedCount { 0 };
+    /// @brief tasks sent with sendCoalesced() that are waiting in the queue (created on first use)
+    std::shared_ptr<CoalescedTaskMap> coalescedTasks;
+    std::once_flag coalescedTasksFlag;
+    /// @brief sub-queues of this queue
+    std::shared_ptr<SubQueueList> subQueueList { std::make_shared<SubQueueList>() };
+    /// @brief entry of this queue in it's parent queue (nullptr if this is not a sub-queue)
+    std::shared_ptr<SubQueueLink> parentLink;
+    std::list<std::weak_ptr<TaskQueue>>::iterator parentPosition;
+    /// @brief sub-queues that have tasks ordered by their pass (only accessed by the consumer)
+    std::vector<std::shared_ptr<SubQueueLink>> readySubQueues;
+    /// @brief pass of the last task taken from this queue or it's sub-queues
+    std::uint64_t virtualTime { 0 };
+    /// @brief pass of main queue
+    std::uint64_t mainPass { 0 };
+    /// @brief average cost of a task taken from main queue in nanoseconds
+    std::atomic<std::uint64_t> mainCost { 0 };
+    std::atomic<std::size_t> executedCount { 0 };
+    std::atomic<std::uint64_t> executionTime { 0 };
+    std::atomic<std::uint64_t> totalWaitTime { 0 };
+    std::atomic<std::uint64_t> maxWaitTime { 0 };
+    std::atomic<std::size_t> deadlineMissCount { 0 };
+    std::atomic<std::size_t> expiredCount { 0 };
+    std::function<void(std::size_t)> queueNotifyCallback { nullptr };
     std::recursive_mutex taskQueueMutex;
     std::recursive_mutex queueNotifyMutex;
-    std::mutex waitMutex;
-    std::condition_variable queueWait;
 
 };
 
@@ -657,10 +3083,10 @@ private:
 class SerialTaskQueue : public TaskQueue
 {
 public:
-    SerialTaskQueue(const std::string& initQueueName)
-        : TaskQueue([this](){
+    SerialTaskQueue(const std::string& initQueueName, const TaskQueueOptions& initOptions = {})
+        : TaskQueue([this](std::size_t){
             notifyQueueOne();
-        })
+        }, initOptions, std::make_shared<EventCount>())
         , localThread(initQueueName, std::bind(&SerialTaskQueue::runLoop, this, std::placeholders::_1))
         , thread(localThread)
     {
@@ -670,10 +3096,10 @@ public:
     SerialTaskQueue()
         : SerialTaskQueue("gusc::Threads::SerialTaskQueue")
     {}
-    SerialTaskQueue(ThisThread& initThread)
-        : TaskQueue([this](){
+    SerialTaskQueue(ThisThread& initThread, const TaskQueueOptions& initOptions = {})
+        : TaskQueue([this](std::size_t){
             notifyQueueOne();
-        })
+        }, initOptions, std::make_shared<EventCount>())
         , thread(initThread)
     {
         initThread.setThreadProcedure(std::bind(&SerialTaskQueue::runLoop, this, std::placeholders::_1));
@@ -698,10 +3124,10 @@ private:
 class ParallelTaskQueue : public TaskQueue
 {
 public:
-    ParallelTaskQueue(const std::string& initQueueName, std::size_t initQueueCount)
-        : TaskQueue([this](){
+    ParallelTaskQueue(const std::string& initQueueName, std::size_t initQueueCount, const TaskQueueOptions& initOptions = {})
+        : TaskQueue([this](std::size_t){
             notifyQueueOne();
-        })
+        }, initOptions, std::make_shared<EventCount>(), false)
         , threadPool(initQueueName, initQueueCount, std::bind(&ParallelTaskQueue::runLoop, this, std::placeholders::_1))
     {
         threadPool.start();
@@ -0,0 +1,196 @@
+//
+//  TimerService.hpp
+//  Threads
+//
+//  Created by Gusts Kaksis on 16/10/2026.
+//  Copyright © 2026 Gusts Kaksis. All rights reserved.
+//
+
+#ifndef GUSC_TIMERSERVICE_HPP
+#define GUSC_TIMERSERVICE_HPP
+
+#include "Thread.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace gusc
+{
+namespace Threads
+{
+
+/// @brief Class representing a thread that keeps timers of many task queues, so that queue threads don't have to wake up or lock just to look at them
+/// @note task queues opt in through TaskQueueOptions::timerService, each queue has a single timer in the service that's set to the time of it's
+/// earliest delayed task and the timer moves due tasks to the queue on the timer service thread
+class TimerService
+{
+public:
+    /// @brief timer of a single client, it's callback is called on the timer service thread
+    class Timer
+    {
+    public:
+        /// @param initCallback - callable object with signature time_point(time_point timeNow) that does the work that's due and returns the time
+        /// at which it has to be called again (time_point::max() - not until the timer is scheduled again)
+        Timer(TimerService& initService, std::function<std::chrono::time_point<std::chrono::steady_clock>(std::chrono::time_point<std::chrono::steady_clock>)> initCallback)
+            : service(initService)
+            , callback(std::move(initCallback))
+        {}
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+        Timer(Timer&&) = delete;
+        Timer& operator=(Timer&&) = delete;
+        /// @note waits for the callback to return if it's being called right now
+        ~Timer()
+        {
+            service.unlinkTimer(*this);
+        }
+
+        /// @brief make sure the callback is called no later than given time (an earlier time that's already set is kept)
+        inline void schedule(std::chrono::time_point<std::chrono::steady_clock> time)
+        {
+            service.scheduleTimer(*this, time);
+        }
+
+        inline TimerService& getService() const noexcept
+        {
+            return service;
+        }
+
+    private:
+        friend class TimerService;
+        TimerService& service;
+        std::function<std::chrono::time_point<std::chrono::steady_clock>(std::chrono::time_point<std::chrono::steady_clock>)> callback;
+        std::multimap<std::chrono::time_point<std::chrono::steady_clock>, Timer*>::iterator position;
+        bool isLinked { false };
+    };
+
+    TimerService(const std::string& initThreadName = "gusc::Threads::TimerService")
+        : thread(initThreadName, std::bind(&TimerService::runLoop, this, std::placeholders::_1))
+    {
+        thread.start();
+    }
+    TimerService(const TimerService&) = delete;
+    TimerService& operator=(const TimerService&) = delete;
+    TimerService(TimerService&&) = delete;
+    TimerService& operator=(TimerService&&) = delete;
+    /// @note all the timers have to be destroyed before the service
+    ~TimerService()
+    {
+        thread.stop();
+        {
+            const std::lock_guard lock(mutex);
+            condition.notify_all();
+        }
+        thread.join();
+    }
+
+    /// @brief get process-wide default instance
+    /// @note it's destroyed at exit, so task queues that use it must not outlive main()
+    static inline TimerService* getDefault()
+    {
+        static TimerService service;
+        return &service;
+    }
+
+    /// @brief get the number of timers that are waiting
+    inline std::size_t getTimerCount()
+    {
+        const std::lock_guard lock(mutex);
+        return timers.size();
+    }
+
+private:
+    using TimerQueue = std::multimap<std::chrono::time_point<std::chrono::steady_clock>, Timer*>;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    /// @brief timers ordered by their time
+    TimerQueue timers;
+    /// @brief timer which callback is being called right now
+    Timer* runningTimer { nullptr };
+    Thread thread;
+
+    inline void scheduleTimer(Timer& timer, std::chrono::time_point<std::chrono::steady_clock> time)
+    {
+        const std::lock_guard lock(mutex);
+        linkTimer(timer, time);
+    }
+
+    /// @note this has to be called with mutex locked
+    inline void linkTimer(Timer& timer, std::chrono::time_point<std::chrono::steady_clock> time)
+    {
+        if (timer.isLinked)
+        {
+            if (timer.position->first <= time)
+            {
+                return;
+            }
+            timers.erase(timer.position);
+        }
+        timer.position = timers.emplace(time, &timer);
+        timer.isLinked = true;
+        if (timer.position == timers.begin())
+        {
+            // Timer service thread might be waiting for a later timer
+            condition.notify_all();
+        }
+    }
+
+    inline void unlinkTimer(Timer& timer)
+    {
+        std::unique_lock lock(mutex);
+        if (timer.isLinked)
+        {
+            timers.erase(timer.position);
+            timer.isLinked = false;
+        }
+        if (thread.getId() != std::this_thread::get_id())
+        {
+            condition.wait(lock, [this, &timer](){
+                return runningTimer != &timer;
+            });
+        }
+    }
+
+    inline void runLoop(const Thread::StopToken& stopToken)
+    {
+        std::unique_lock lock(mutex);
+        while (!stopToken.getIsStopping())
+        {
+            if (timers.empty())
+            {
+                condition.wait(lock);
+                continue;
+            }
+            const auto timeNow = std::chrono::steady_clock::now();
+            const auto it = timers.begin();
+            if (timeNow <= it->first)
+            {
+                condition.wait_until(lock, it->first);
+                continue;
+            }
+            auto& timer = *it->second;
+            timers.erase(it);
+            timer.isLinked = false;
+            runningTimer = &timer;
+            lock.unlock();
+            const auto timeNext = timer.callback(timeNow);
+            lock.lock();
+            runningTimer = nullptr;
+            if (timeNext != std::chrono::time_point<std::chrono::steady_clock>::max())
+            {
+                linkTimer(timer, timeNext);
+            }
+            // Let the owner of the timer know if it's waiting to destroy it
+            condition.notify_all();
+        }
+    }
+};
+
+}
+} // namespace gusc::Threads
+
+#endif /* GUSC_TIMERSERVICE_HPP */
@@ -0,0 +1,143 @@
+//
+//  BlockPool.hpp
+//  Threads
+//
+//  Created by Gusts Kaksis on 16/10/2026.
+//  Copyright © 2026 Gusts Kaksis. All rights reserved.
+//
+
+#ifndef GUSC_BLOCKPOOL_HPP
+#define GUSC_BLOCKPOOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+namespace gusc::Threads
+{
+
+/// @brief Process-wide pool of fixed-size memory blocks with per-thread caches
+/// Each thread allocates from and frees to it's own cache without any synchronization, caches that grow too big are handed
+/// over to a shared lock-free list in batches, where threads that run out of blocks pick them up (this way a block allocated by
+/// a producer and freed by a consumer finds it's way back to the producer without going through the global allocator)
+/// @note blocks are never returned to the system, the pool grows to the peak number of blocks in use
+template<std::size_t BlockSize, std::size_t BlockAlignment = alignof(std::max_align_t)>
+class BlockPool
+{
+public:
+    static_assert(BlockSize >= sizeof(void*), "Block must be able to hold a pointer");
+
+    static inline void* allocate()
+    {
+        auto& cache = getCache();
+        if (!cache.head)
+        {
+            // Take everything other threads have handed over
+            cache.head = shared.exchange(nullptr, std::memory_order_acquire);
+            if (!cache.head)
+            {
+                systemAllocationCount.fetch_add(1, std::memory_order_relaxed);
+                return ::operator new(BlockSize, std::align_val_t{ BlockAlignment });
+            }
+        }
+        auto block = cache.head;
+        cache.head = block->next;
+        if (block == cache.tail)
+        {
+            cache.tail = nullptr;
+            cache.count = 0;
+        }
+        else if (cache.tail)
+        {
+            --cache.count;
+        }
+        return block;
+    }
+
+    static inline void deallocate(void* ptr) noexcept
+    {
+        auto& cache = getCache();
+        auto block = new (ptr) FreeBlock{ cache.head };
+        if (!cache.tail)
+        {
+            cache.tail = block;
+        }
+        cache.head = block;
+        if (++cache.count >= BatchSize)
+        {
+            cache.handOver();
+        }
+    }
+
+    /// @brief hand over blocks freed on this thread to other threads (e.g. when this thread is about to go idle)
+    static inline void flushThreadCache() noexcept
+    {
+        getCache().handOver();
+    }
+
+    /// @brief get the number of blocks requested from the system so far
+    static inline std::size_t getSystemAllocationCount() noexcept
+    {
+        return systemAllocationCount.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr std::size_t BatchSize { 32 };
+
+    struct FreeBlock
+    {
+        FreeBlock* next { nullptr };
+    };
+
+    /// @brief per-thread block cache - the list starts with blocks freed on this thread (up to tail, those can be handed over in one go)
+    /// followed by blocks taken from the shared list
+    struct Cache
+    {
+        FreeBlock* head { nullptr };
+        FreeBlock* tail { nullptr };
+        std::size_t count { 0 };
+
+        ~Cache()
+        {
+            // Return all the blocks to other threads when this thread exits
+            if (head)
+            {
+                tail = head;
+                while (tail->next)
+                {
+                    tail = tail->next;
+                }
+                handOver();
+            }
+        }
+
+        inline void handOver() noexcept
+        {
+            if (!head || !tail)
+            {
+                return;
+            }
+            auto first = head;
+            auto last = tail;
+            head = last->next;
+            tail = nullptr;
+            count = 0;
+            last->next = shared.load(std::memory_order_relaxed);
+            while (!shared.compare_exchange_weak(last->next, first, std::memory_order_release, std::memory_order_relaxed))
+            {}
+        }
+    };
+
+    static inline std::atomic<FreeBlock*> shared { nullptr };
+    static inline std::atomic<std::size_t> systemAllocationCount { 0 };
+
+    static inline Cache& getCache() noexcept
+    {
+        thread_local Cache cache;
+        return cache;
+    }
+};
+
+} // namespace gusc::Threads
+
+#endif /* GUSC_BLOCKPOOL_HPP */
@@ -0,0 +1,191 @@
+//
+//  EventCount.hpp
+//  Threads
+//
+//  Created by Gusts Kaksis on 16/10/2026.
+//  Copyright © 2026 Gusts Kaksis. All rights reserved.
+//
+
+#ifndef GUSC_EVENTCOUNT_HPP
+#define GUSC_EVENTCOUNT_HPP
+
+#include "PreciseTimer.hpp"
+#include "Utilities.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace gusc::Threads
+{
+
+/// @brief Event count - a condition variable for lock-free data structures, which keeps track of waiting threads so that
+/// notifying costs a single atomic load while nobody is waiting (the mutex and condition variable are only touched when a thread is asleep)
+/// Waiting thread calls prepareWait(), checks the condition once more and then either calls cancelWait() or wait()
+/// Notifying thread changes the condition and then calls notify()
+class EventCount
+{
+public:
+    using Key = std::uint32_t;
+
+    EventCount() = default;
+    EventCount(const EventCount&) = delete;
+    EventCount& operator=(const EventCount&) = delete;
+    EventCount(EventCount&&) = delete;
+    EventCount& operator=(EventCount&&) = delete;
+
+    /// @brief announce that calling thread is about to wait
+    /// @return key that has to be passed to wait() or waitUntil()
+    inline Key prepareWait() noexcept
+    {
+        const auto previous = state.fetch_add(WaiterIncrement, std::memory_order_seq_cst);
+        // Condition re-check that follows must not be reordered before the waiter is visible to notifiers
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return static_cast<Key>(previous >> EpochShift);
+    }
+
+    /// @brief withdraw from waiting (condition became true after prepareWait())
+    inline void cancelWait() noexcept
+    {
+        state.fetch_sub(WaiterIncrement, std::memory_order_seq_cst);
+    }
+
+    /// @brief block until notify() is called after prepareWait() returned the key
+    inline void wait(Key key)
+    {
+        {
+            std::unique_lock lock { mutex };
+            wakeUp.wait(lock, [&](){
+                return getEpoch() != key;
+            });
+        }
+        cancelWait();
+    }
+
+    /// @brief block until notify() is called after prepareWait() returned the key or the time point is reached
+    /// @return false if time point was reached without a notification
+    template<typename TClock, typename TDuration>
+    inline bool waitUntil(Key key, const std::chrono::time_point<TClock, TDuration>& time)
+    {
+        bool isNotified { false };
+        {
+            std::unique_lock lock { mutex };
+            isNotified = wakeUp.wait_until(lock, time, [&](){
+                return getEpoch() != key;
+            });
+        }
+        cancelWait();
+        return isNotified;
+    }
+
+    /// @brief sleep on a precise timer until notify() is called after prepareWait() returned the key or the time point is reached, the last
+    /// PreciseTimer::getSpinDuration() before the time point is spent busy-waiting, so that the thread is not late by it's wake-up latency
+    /// @return false if time point was reached without a notification
+    /// @note only one thread at a time can wait on a precise timer
+    inline bool waitUntil(Key key, std::chrono::time_point<std::chrono::steady_clock> time, PreciseTimer& timer)
+    {
+        bool isNotified { false };
+        const auto sleepTime = time - timer.getSpinDuration();
+        if (std::chrono::steady_clock::now() < sleepTime)
+        {
+            {
+                const std::lock_guard lock { mutex };
+                // Notifier increments the epoch before it locks the mutex, so it either sees the timer or we see the new epoch
+                isNotified = getEpoch() != key;
+                preciseWaiter = isNotified ? nullptr : &timer;
+            }
+            if (!isNotified)
+            {
+                isNotified = timer.sleepUntil(sleepTime);
+                const std::lock_guard lock { mutex };
+                preciseWaiter = nullptr;
+            }
+        }
+        if (!isNotified)
+        {
+            isNotified = spinUntil(key, time);
+        }
+        cancelWait();
+        return isNotified;
+    }
+
+    /// @brief busy-wait until notify() is called after prepareWait() returned the key or the time point is reached
+    /// @return false if time point was reached without a notification
+    /// @note calling thread stays registered as a waiter either way, so it has to follow up with cancelWait(), wait() or waitUntil()
+    template<typename TClock, typename TDuration>
+    inline bool spinUntil(Key key, const std::chrono::time_point<TClock, TDuration>& time) const noexcept
+    {
+        for (std::size_t i = 0; getEpoch() == key; ++i)
+        {
+            // Reading the clock is more expensive than reading the epoch, so we do it less often
+            if (i % SpinClockInterval == 0 && TClock::now() >= time)
+            {
+                return false;
+            }
+            cpuRelax();
+        }
+        return true;
+    }
+
+    /// @brief wake up to count waiting threads (all of them if count is not smaller than the number of waiting threads)
+    inline void notify(std::size_t count = 1)
+    {
+        // Pairs with the fence in prepareWait(), so that either we see the waiter or the waiter sees the changed condition
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const auto waiterCount = static_cast<std::size_t>(state.load(std::memory_order_relaxed) & WaiterMask);
+        if (waiterCount == 0)
+        {
+            return;
+        }
+        state.fetch_add(EpochIncrement, std::memory_order_seq_cst);
+        {
+            // Waiter has either not checked the epoch yet or is already blocked on the condition variable (or the precise timer)
+            const std::lock_guard lock { mutex };
+            if (preciseWaiter)
+            {
+                preciseWaiter->wake();
+            }
+        }
+        if (count >= waiterCount)
+        {
+            wakeUp.notify_all();
+        }
+        else
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                wakeUp.notify_one();
+            }
+        }
+    }
+
+    /// @brief wake up all waiting threads
+    inline void notifyAll()
+    {
+        notify(WaiterMask);
+    }
+
+private:
+    static constexpr std::uint64_t WaiterIncrement { 1 };
+    static constexpr std::uint64_t EpochShift { 32 };
+    static constexpr std::uint64_t EpochIncrement { std::uint64_t{ 1 } << EpochShift };
+    static constexpr std::uint64_t WaiterMask { EpochIncrement - 1 };
+    static constexpr std::size_t SpinClockInterval { 16 };
+
+    /// @brief lower 32 bits hold the number of waiting threads, upper 32 bits hold the notification epoch
+    std::atomic<std::uint64_t> state { 0 };
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    /// @brief timer a thread is sleeping on instead of the condition variable (guarded by the mutex)
+    PreciseTimer* preciseWaiter { nullptr };
+
+    inline Key getEpoch() const noexcept
+    {
+        return static_cast<Key>(state.load(std::memory_order_seq_cst) >> EpochShift);
+    }
+};
+
+} // namespace gusc::Threads
+
+#endif /* GUSC_EVENTCOUNT_HPP */
@@ -0,0 +1,132 @@
+//
+//  IdleState.hpp
+//  Threads
+//
+//  Created by Gusts Kaksis on 16/10/2026.
+//  Copyright © 2026 Gusts Kaksis. All rights reserved.
+//
+
+#ifndef GUSC_IDLESTATE_HPP
+#define GUSC_IDLESTATE_HPP
+
+#include "EventCount.hpp"
+#include "../SlabMemoryResource.hpp"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+namespace gusc::Threads
+{
+
+/// @brief What a task queue thread does when it runs out of tasks
+enum class IdlePolicy
+{
+    /// @brief go to sleep right away
+    Blocking,
+    /// @brief spin for TaskQueueOptions::maxSpinDuration before going to sleep
+    Spin,
+    /// @brief spin for a duration learned from recent gaps between tasks (up to TaskQueueOptions::maxSpinDuration) before going to sleep
+    Adaptive
+};
+
+/// @brief How precisely a task queue thread wakes up for it's next delayed task
+enum class TimerPrecision
+{
+    /// @brief sleep on the condition variable, which is subject to timer slack of the OS (on Linux the thread usually wakes up 50-100 us late)
+    Default,
+    /// @brief sleep on a timerfd armed with an absolute time with the timer slack of the thread lowered and spin for
+    /// TaskQueueOptions::timerSpinDuration before the task is due (only serial queues on Linux, elsewhere it's the same as Default)
+    High
+};
+
+/// @brief Per-thread idle state of a task queue thread that decides how long to spin before going to sleep
+class IdleState
+{
+public:
+    /// @note idle state with TimerPrecision::High has to be created on the thread that waits
+    IdleState(IdlePolicy initPolicy,
+              std::chrono::nanoseconds initMaxSpinDuration,
+              TimerPrecision initTimerPrecision = TimerPrecision::Default,
+              std::chrono::nanoseconds initTimerSpinDuration = std::chrono::nanoseconds::zero())
+        : policy(initPolicy)
+        , maxSpinDuration(initMaxSpinDuration)
+    {
+        if (initTimerPrecision == TimerPrecision::High)
+        {
+            preciseTimer = std::make_unique<PreciseTimer>(initTimerSpinDuration);
+            if (!preciseTimer->getIsAvailable())
+            {
+                preciseTimer.reset();
+            }
+        }
+    }
+
+    inline std::chrono::nanoseconds getSpinDuration() const noexcept
+    {
+        switch (policy)
+        {
+            case IdlePolicy::Spin:
+                return maxSpinDuration;
+            case IdlePolicy::Adaptive:
+                // Spin a bit longer than tasks usually take to arrive, but don't bother if they arrive too rarely
+                return averageIdleTime <= maxSpinDuration ? std::min(averageIdleTime * 2, maxSpinDuration) : std::chrono::nanoseconds::zero();
+            default:
+                return std::chrono::nanoseconds::zero();
+        }
+    }
+
+    /// @brief spin and/or sleep until the event count is notified or the wake-up time is reached
+    /// @param eventCount - event count the thread waits on
+    /// @param waitKey - key returned by EventCount::prepareWait()
+    /// @param idleStart - time when the thread ran out of tasks
+    /// @param wakeUpTime - time of the next delayed task or time_point::max() if there are none
+    inline void wait(EventCount& eventCount,
+                     EventCount::Key waitKey,
+                     std::chrono::time_point<std::chrono::steady_clock> idleStart,
+                     std::chrono::time_point<std::chrono::steady_clock> wakeUpTime)
+    {
+        bool isNotified { false };
+        const auto spinDuration = getSpinDuration();
+        if (spinDuration.count() > 0 && eventCount.spinUntil(waitKey, std::min(wakeUpTime, idleStart + spinDuration)))
+        {
+            // A task arrived while we were spinning, so we saved ourselves a trip through the OS scheduler
+            eventCount.cancelWait();
+            isNotified = true;
+        }
+        else if (wakeUpTime != std::chrono::time_point<std::chrono::steady_clock>::max())
+        {
+            // There are no tasks to process, but there are delayed tasks, we can wait till delay expires
+            SlabMemoryResource::flushThreadCache();
+            isNotified = preciseTimer ? eventCount.waitUntil(waitKey, wakeUpTime, *preciseTimer) : eventCount.waitUntil(waitKey, wakeUpTime);
+        }
+        else
+        {
+            // We wait for a new task to be pushed on any of the queues
+            SlabMemoryResource::flushThreadCache();
+            eventCount.wait(waitKey);
+            isNotified = true;
+        }
+        if (isNotified && policy == IdlePolicy::Adaptive)
+        {
+            addIdleTime(std::chrono::steady_clock::now() - idleStart);
+        }
+    }
+
+private:
+    IdlePolicy policy;
+    std::chrono::nanoseconds maxSpinDuration;
+    std::chrono::nanoseconds averageIdleTime { 0 };
+    /// @brief timer the thread sleeps on while it waits for a delayed task (nullptr - condition variable of the event count is used)
+    std::unique_ptr<PreciseTimer> preciseTimer;
+
+    /// @brief record how long the thread was idle before a new task arrived
+    inline void addIdleTime(std::chrono::nanoseconds idleTime) noexcept
+    {
+        // Exponential moving average where the newest sample has a weight of 1/8
+        averageIdleTime += (idleTime - averageIdleTime) / 8;
+    }
+};
+
+} // namespace gusc::Threads
+
+#endif /* GUSC_IDLESTATE_HPP */
@@ -0,0 +1,116 @@
+//
+//  InlineCallable.hpp
+//  Threads
+//
+//  Created by Gusts Kaksis on 16/10/2026.
+//  Copyright © 2026 Gusts Kaksis. All rights reserved.
+//
+
+#ifndef GUSC_INLINECALLABLE_HPP
+#define GUSC_INLINECALLABLE_HPP
+
+#include <cstddef>
+#include <functional>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+
+namespace gusc::Threads
+{
+
+/// @brief Type-erased callable object (signature void(void)) with small-buffer storage
+/// Callable objects up to InlineSize bytes are stored inline, larger (or over-aligned) objects are allocated from the memory resource
+/// @note the object is neither copyable nor movable as it's meant to live inside an intrusive queue node
+template<std::size_t InlineSize>
+class InlineCallable
+{
+public:
+    template<typename TCallable>
+    static constexpr bool IsStoredInline = sizeof(TCallable) <= InlineSize && alignof(TCallable) <= alignof(std::max_align_t);
+
+    template<typename TCallable>
+    InlineCallable(std::pmr::memory_resource* memoryResource, TCallable&& callableObject)
+    {
+        using TStored = std::decay_t<TCallable>;
+        if constexpr (IsStoredInline<TStored>)
+        {
+            new (&storage) TStored(std::forward<TCallable>(callableObject));
+            operations = &inlineOperations<TStored>;
+        }
+        else
+        {
+            static_assert(sizeof(HeapStorage<TStored>) <= InlineSize, "Inline storage is too small to hold a pointer");
+            auto object = static_cast<TStored*>(memoryResource->allocate(sizeof(TStored), alignof(TStored)));
+            try
+            {
+                new (object) TStored(std::forward<TCallable>(callableObject));
+            }
+            catch (...)
+            {
+                memoryResource->deallocate(object, sizeof(TStored), alignof(TStored));
+                throw;
+            }
+            new (&storage) HeapStorage<TStored>{ object, memoryResource };
+            operations = &heapOperations<TStored>;
+        }
+    }
+    InlineCallable(const InlineCallable&) = delete;
+    InlineCallable& operator=(const InlineCallable&) = delete;
+    InlineCallable(InlineCallable&&) = delete;
+    InlineCallable& operator=(InlineCallable&&) = delete;
+    ~InlineCallable()
+    {
+        operations->destroy(&storage);
+    }
+
+    inline void operator()()
+    {
+        operations->invoke(&storage);
+    }
+
+    /// @brief get the number of bytes the callable object occupies outside of the inline storage
+    inline std::size_t getHeapSize() const noexcept
+    {
+        return operations->heapSize;
+    }
+
+private:
+    struct Operations
+    {
+        void (*invoke)(void*);
+        void (*destroy)(void*) noexcept;
+        std::size_t heapSize;
+    };
+
+    template<typename TStored>
+    static constexpr Operations inlineOperations {
+        [](void* ptr) { std::invoke(*static_cast<TStored*>(ptr)); },
+        [](void* ptr) noexcept { static_cast<TStored*>(ptr)->~TStored(); },
+        0
+    };
+
+    template<typename TStored>
+    struct HeapStorage
+    {
+        TStored* object;
+        std::pmr::memory_resource* memoryResource;
+    };
+
+    template<typename TStored>
+    static constexpr Operations heapOperations {
+        [](void* ptr) { std::invoke(*static_cast<HeapStorage<TStored>*>(ptr)->object); },
+        [](void* ptr) noexcept {
+            auto heap = static_cast<HeapStorage<TStored>*>(ptr);
+            heap->object->~TStored();
+            heap->memoryResource->deallocate(heap->object, sizeof(TStored), alignof(TStored));
+        },
+        sizeof(TStored)
+    };
+
+    const Operations* operations { nullptr };
+    alignas(std::max_align_t) unsigned char storage[InlineSize];
+};
+
+} // namespace gusc::Threads
+
+#endif /* GUSC_INLINECALLABLE_HPP */
@@ -0,0 +1,129 @@
+//
+//  IntrusiveMpscQueue.hpp
+//  Threads
+//
+//  Created by Gusts Kaksis on 16/10/2026.
+//  Copyright © 2026 Gusts Kaksis. All rights reserved.
+//
+
+#ifndef GUSC_INTRUSIVEMPSCQUEUE_HPP
+#define GUSC_INTRUSIVEMPSCQUEUE_HPP
+
+#include <atomic>
+
+namespace gusc::Threads
+{
+
+/// @brief Base class for nodes that can be linked into IntrusiveMpscQueue
+class MpscQueueNode
+{
+    template<typename> friend class IntrusiveMpscQueue;
+    std::atomic<MpscQueueNode*> next { nullptr };
+};
+
+/// @brief Unbounded intrusive multi-producer single-consumer FIFO queue (Dmitry Vyukov's algorithm)
+/// @note push() may be called from any thread and costs a single atomic exchange, while pop() and empty() must only be called by one consumer at a time
+template<typename TNode>
+class IntrusiveMpscQueue
+{
+public:
+    IntrusiveMpscQueue() = default;
+    IntrusiveMpscQueue(const IntrusiveMpscQueue&) = delete;
+    IntrusiveMpscQueue& operator=(const IntrusiveMpscQueue&) = delete;
+    IntrusiveMpscQueue(IntrusiveMpscQueue&&) = delete;
+    IntrusiveMpscQueue& operator=(IntrusiveMpscQueue&&) = delete;
+
+    /// @brief link a node at the end of the queue
+    inline void push(TNode* node) noexcept
+    {
+        pushNode(node);
+    }
+
+    /// @brief link a chain of nodes (joined together with link()) at the end of the queue with a single atomic exchange
+    inline void push(TNode* first, TNode* last) noexcept
+    {
+        last->next.store(nullptr, std::memory_order_relaxed);
+        auto prev = head.exchange(last, std::memory_order_acq_rel);
+        prev->next.store(first, std::memory_order_release);
+    }
+
+    /// @brief join two nodes to build a chain that is not yet visible to the consumer
+    static inline void link(TNode* node, TNode* next) noexcept
+    {
+        node->next.store(next, std::memory_order_relaxed);
+    }
+
+    /// @brief get the node that follows given node in a chain that is not yet visible to the consumer
+    static inline TNode* getNext(TNode* node) noexcept
+    {
+        return static_cast<TNode*>(node->next.load(std::memory_order_relaxed));
+    }
+
+    /// @brief unlink a node from the front of the queue
+    /// @return a node or nullptr if queue is empty (or the only node is still being linked in by a producer)
+    inline TNode* pop() noexcept
+    {
+        auto current = tail;
+        auto next = current->next.load(std::memory_order_acquire);
+        if (current == &stub)
+        {
+            if (!next)
+            {
+                return nullptr;
+            }
+            // Skip the stub node
+            tail = next;
+            current = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next)
+        {
+            tail = next;
+            return static_cast<TNode*>(current);
+        }
+        if (current != head.load(std::memory_order_acquire))
+        {
+            // A producer has already swapped the head, but hasn't linked the previous node yet
+            return nullptr;
+        }
+        // This is the last node, put the stub back behind it so that we can unlink it
+        pushNode(&stub);
+        next = current->next.load(std::memory_order_acquire);
+        if (next)
+        {
+            tail = next;
+            return static_cast<TNode*>(current);
+        }
+        return nullptr;
+    }
+
+    /// @brief check if there are no nodes in the queue
+    inline bool empty() const noexcept
+    {
+        return tail == &stub && head.load(std::memory_order_acquire) == &stub;
+    }
+
+    /// @brief check if every node pushed so far has already been popped, this can be called from any thread
+    /// @note the result may be a false negative while the consumer is in the middle of pop() or a producer in the middle of push()
+    inline bool drained() const noexcept
+    {
+        // Consumer links the stub back in only after it has popped the last node
+        return head.load(std::memory_order_acquire) == &stub;
+    }
+
+private:
+    alignas(64) std::atomic<MpscQueueNode*> head { &stub };
+    alignas(64) MpscQueueNode* tail { &stub };
+    MpscQueueNode stub;
+
+    inline void pushNode(MpscQueueNode* node) noexcept
+    {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        auto prev = head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+};
+
+} // namespace gusc::Threads
+
+#endif /* GUSC_INTRUSIVEMPSCQUEUE_HPP */
@@ -0,0 +1,139 @@
+//
+//  PreciseTimer.hpp
+//  Threads
+//
+//  Created by Gusts Kaksis on 16/10/2026.
+//  Copyright © 2026 Gusts Kaksis. All rights reserved.
+//
+
+#ifndef GUSC_PRECISETIMER_HPP
+#define GUSC_PRECISETIMER_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+#if defined(__linux__)
+#   include <cerrno>
+#   include <poll.h>
+#   include <sys/eventfd.h>
+#   include <sys/prctl.h>
+#   include <sys/timerfd.h>
+#   include <unistd.h>
+#endif
+
+namespace gusc::Threads
+{
+
+/// @brief Timer that wakes up a sleeping thread at an absolute time without timer slack, the sleep can be interrupted from other threads
+/// On Linux it's a timerfd armed with TFD_TIMER_ABSTIME that's polled together with an eventfd, other platforms don't have it
+/// @note only one thread can sleep on the timer at a time
+class PreciseTimer
+{
+public:
+    /// @param initSpinDuration - time the thread spins before the time point instead of sleeping (see EventCount::waitUntil())
+    /// @note while the timer exists the timer slack of calling thread is lowered too, so the timer has to be created and destroyed on the
+    /// thread that sleeps on it
+    explicit PreciseTimer(std::chrono::nanoseconds initSpinDuration) noexcept
+        : spinDuration(initSpinDuration)
+    {
+#if defined(__linux__)
+        timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+        wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (getIsAvailable())
+        {
+            // Other timed sleeps of the thread are not rounded up by the default 50 us slack either (the thread might belong to the
+            // caller, so the slack it had is restored once we are done)
+            const auto slack = prctl(PR_GET_TIMERSLACK, 0UL, 0UL, 0UL, 0UL);
+            if (slack > 0 && prctl(PR_SET_TIMERSLACK, 1UL, 0UL, 0UL, 0UL) == 0)
+            {
+                previousTimerSlack = static_cast<unsigned long>(slack);
+            }
+        }
+#endif
+    }
+    PreciseTimer(const PreciseTimer&) = delete;
+    PreciseTimer& operator=(const PreciseTimer&) = delete;
+    PreciseTimer(PreciseTimer&&) = delete;
+    PreciseTimer& operator=(PreciseTimer&&) = delete;
+    ~PreciseTimer()
+    {
+#if defined(__linux__)
+        if (previousTimerSlack != 0)
+        {
+            prctl(PR_SET_TIMERSLACK, previousTimerSlack, 0UL, 0UL, 0UL);
+        }
+        if (timerFd >= 0)
+        {
+            close(timerFd);
+        }
+        if (wakeFd >= 0)
+        {
+            close(wakeFd);
+        }
+#endif
+    }
+
+    /// @brief check if the platform has a precise timer (if not the thread has to sleep some other way)
+    inline bool getIsAvailable() const noexcept
+    {
+        return timerFd >= 0 && wakeFd >= 0;
+    }
+
+    inline std::chrono::nanoseconds getSpinDuration() const noexcept
+    {
+        return spinDuration;
+    }
+
+    /// @brief sleep until the time point is reached or wake() is called
+    /// @return false if the time point was reached without wake()
+    /// @note time point is given in std::chrono::steady_clock, which is CLOCK_MONOTONIC on Linux
+    inline bool sleepUntil(std::chrono::time_point<std::chrono::steady_clock> time) noexcept
+    {
+#if defined(__linux__)
+        // Zero would disarm the timer, so the earliest time we can ask for is 1 ns
+        const auto count = std::max<std::int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count(), 1);
+        itimerspec spec {};
+        spec.it_value.tv_sec = static_cast<time_t>(count / 1'000'000'000);
+        spec.it_value.tv_nsec = static_cast<long>(count % 1'000'000'000);
+        timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &spec, nullptr);
+        pollfd fds[2] {
+            { wakeFd, POLLIN, 0 },
+            { timerFd, POLLIN, 0 }
+        };
+        while (poll(fds, 2, -1) < 0 && errno == EINTR)
+        {}
+        std::uint64_t value { 0 };
+        if (fds[0].revents & POLLIN)
+        {
+            [[maybe_unused]] const auto result = read(wakeFd, &value, sizeof(value));
+            return true;
+        }
+        [[maybe_unused]] const auto result = read(timerFd, &value, sizeof(value));
+        return false;
+#else
+        (void)time;
+        return false;
+#endif
+    }
+
+    /// @brief interrupt the sleep (if the thread is not sleeping yet, it's next sleep returns right away)
+    inline void wake() noexcept
+    {
+#if defined(__linux__)
+        const std::uint64_t value { 1 };
+        [[maybe_unused]] const auto result = write(wakeFd, &value, sizeof(value));
+#endif
+    }
+
+private:
+    std::chrono::nanoseconds spinDuration;
+    int timerFd { -1 };
+    int wakeFd { -1 };
+    /// @brief timer slack the thread had before the timer was created in nanoseconds (0 - it was not changed)
+    unsigned long previousTimerSlack { 0 };
+};
+
+} // namespace gusc::Threads
+
+#endif /* GUSC_PRECISETIMER_HPP */
@@ -0,0 +1,168 @@
+//
+//  SpscQueue.hpp
+//  Threads
+//
+//  Created by Gusts Kaksis on 16/10/2026.
+//  Copyright © 2026 Gusts Kaksis. All rights reserved.
+//
+
+#ifndef GUSC_SPSCQUEUE_HPP
+#define GUSC_SPSCQUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+namespace gusc::Threads
+{
+
+/// @brief Unbounded single-producer single-consumer FIFO queue made of fixed-size ring segments
+/// Elements are constructed in place inside the segments (they don't need to be movable), producer and consumer only share
+/// an index per segment, and a drained segment is recycled for the producer, so in steady state the queue does not allocate
+/// @note emplace() must only be called by one producer at a time and consume() and empty() by one consumer at a time
+template<typename T, std::size_t SegmentSize = 64>
+class SpscQueue
+{
+public:
+    SpscQueue(std::pmr::memory_resource* initMemoryResource)
+        : memoryResource(initMemoryResource)
+        , writeSegment(createSegment())
+        , readSegment(writeSegment)
+    {}
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+    SpscQueue(SpscQueue&&) = delete;
+    SpscQueue& operator=(SpscQueue&&) = delete;
+    ~SpscQueue()
+    {
+        // Destroy elements that were never consumed
+        while (consume([](T&){}))
+        {}
+        destroySegment(readSegment);
+        destroySegment(spare.load(std::memory_order_relaxed));
+    }
+
+    /// @brief construct an element at the end of the queue
+    template<typename... TArgs>
+    inline void emplace(TArgs&&... args)
+    {
+        if (writeIndex == SegmentSize)
+        {
+            auto segment = acquireSegment();
+            writeSegment->next.store(segment, std::memory_order_release);
+            writeSegment = segment;
+            writeIndex = 0;
+        }
+        new (writeSegment->getSlot(writeIndex)) T(std::forward<TArgs>(args)...);
+        // Publish the element to the consumer
+        writeSegment->committed.store(++writeIndex, std::memory_order_release);
+    }
+
+    /// @brief pass the element at the front of the queue to a function and destroy it afterwards
+    /// @return false if queue is empty
+    template<typename TFunction>
+    inline bool consume(TFunction&& function)
+    {
+        if (readIndex == SegmentSize)
+        {
+            auto next = readSegment->next.load(std::memory_order_acquire);
+            if (!next)
+            {
+                return false;
+            }
+            // Producer has moved on to the next segment, so this one can be reused
+            releaseSegment(readSegment);
+            readSegment = next;
+            readIndex = 0;
+        }
+        if (readIndex == readSegment->committed.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        auto element = readSegment->getSlot(readIndex++);
+        const ElementGuard guard { element };
+        function(*element);
+        return true;
+    }
+
+    /// @brief check if there are no elements in the queue
+    inline bool empty() const noexcept
+    {
+        if (readIndex == SegmentSize)
+        {
+            const auto next = readSegment->next.load(std::memory_order_acquire);
+            return !next || next->committed.load(std::memory_order_acquire) == 0;
+        }
+        return readIndex == readSegment->committed.load(std::memory_order_acquire);
+    }
+
+private:
+    struct Segment
+    {
+        /// @brief number of elements the producer has constructed in this segment
+        std::atomic<std::size_t> committed { 0 };
+        std::atomic<Segment*> next { nullptr };
+        alignas(T) unsigned char storage[sizeof(T) * SegmentSize];
+
+        inline T* getSlot(std::size_t index) noexcept
+        {
+            return reinterpret_cast<T*>(storage + sizeof(T) * index);
+        }
+    };
+
+    /// @brief destroys an element even if the function consuming it throws
+    struct ElementGuard
+    {
+        T* element;
+        ~ElementGuard()
+        {
+            element->~T();
+        }
+    };
+
+    std::pmr::memory_resource* memoryResource;
+    // Producer side
+    alignas(64) Segment* writeSegment;
+    std::size_t writeIndex { 0 };
+    // Consumer side
+    alignas(64) Segment* readSegment;
+    std::size_t readIndex { 0 };
+    // A drained segment waiting to be reused by the producer
+    alignas(64) std::atomic<Segment*> spare { nullptr };
+
+    inline Segment* createSegment()
+    {
+        return new (memoryResource->allocate(sizeof(Segment), alignof(Segment))) Segment();
+    }
+
+    inline void destroySegment(Segment* segment) noexcept
+    {
+        if (segment)
+        {
+            segment->~Segment();
+            memoryResource->deallocate(segment, sizeof(Segment), alignof(Segment));
+        }
+    }
+
+    inline Segment* acquireSegment()
+    {
+        if (auto segment = spare.exchange(nullptr, std::memory_order_acquire))
+        {
+            segment->committed.store(0, std::memory_order_relaxed);
+            segment->next.store(nullptr, std::memory_order_relaxed);
+            return segment;
+        }
+        return createSegment();
+    }
+
+    inline void releaseSegment(Segment* segment) noexcept
+    {
+        destroySegment(spare.exchange(segment, std::memory_order_acq_rel));
+    }
+};
+
+} // namespace gusc::Threads
+
+#endif /* GUSC_SPSCQUEUE_HPP */
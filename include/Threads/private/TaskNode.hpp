@@ -0,0 +1,129 @@
+//
+//  TaskNode.hpp
+//  Threads
+//
+//  Created by Gusts Kaksis on 16/10/2026.
+//  Copyright © 2026 Gusts Kaksis. All rights reserved.
+//
+
+#ifndef GUSC_TASKNODE_HPP
+#define GUSC_TASKNODE_HPP
+
+#include "InlineCallable.hpp"
+#include "IntrusiveMpscQueue.hpp"
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+
+namespace gusc::Threads
+{
+
+/// @brief a task queue node holding a type-erased callable object
+/// @note small callable objects are stored inline and the nodes themselves are allocated from queue's memory resource (by default
+/// a slab allocator with per-thread caches), so sending a task does not need a heap allocation
+class TaskNode : public MpscQueueNode
+{
+public:
+    static constexpr std::size_t InlineSize { 48 };
+
+    struct Deleter
+    {
+        inline void operator()(TaskNode* node) const noexcept
+        {
+            auto resource = node->memoryResource;
+            node->~TaskNode();
+            resource->deallocate(node, sizeof(TaskNode), alignof(TaskNode));
+        }
+    };
+
+    template<typename TCallable>
+    static inline std::unique_ptr<TaskNode, Deleter> create(std::pmr::memory_resource* memoryResource, TCallable&& callableObject)
+    {
+        auto ptr = memoryResource->allocate(sizeof(TaskNode), alignof(TaskNode));
+        try
+        {
+            return std::unique_ptr<TaskNode, Deleter>(new (ptr) TaskNode(memoryResource, std::forward<TCallable>(callableObject)));
+        }
+        catch (...)
+        {
+            memoryResource->deallocate(ptr, sizeof(TaskNode), alignof(TaskNode));
+            throw;
+        }
+    }
+
+    inline void execute()
+    {
+        callableObject();
+    }
+
+    /// @brief mark the task as one that may be dropped when the queue is overloaded
+    inline void setIsSheddable(bool newIsSheddable) noexcept
+    {
+        isSheddable = newIsSheddable;
+    }
+
+    inline bool getIsSheddable() const noexcept
+    {
+        return isSheddable;
+    }
+
+    /// @brief get the number of bytes the task occupies (the node itself and captures that didn't fit inline)
+    inline std::size_t getSize() const noexcept
+    {
+        return sizeof(TaskNode) + callableObject.getHeapSize();
+    }
+
+    /// @brief set the time the task was sent (only stamped by queues that measure how long their tasks wait)
+    inline void setSendTime(std::chrono::time_point<std::chrono::steady_clock> newSendTime) noexcept
+    {
+        sendTime = newSendTime;
+    }
+
+    inline std::chrono::time_point<std::chrono::steady_clock> getSendTime() const noexcept
+    {
+        return sendTime;
+    }
+
+    /// @brief set the time the task has to be completed by (time_point::max() if the task has no deadline)
+    inline void setDeadline(std::chrono::time_point<std::chrono::steady_clock> newDeadline) noexcept
+    {
+        deadline = newDeadline;
+    }
+
+    inline std::chrono::time_point<std::chrono::steady_clock> getDeadline() const noexcept
+    {
+        return deadline;
+    }
+
+    /// @brief set the time after which the task is dropped instead of being started (time_point::max() if the task never expires)
+    inline void setExpiryTime(std::chrono::time_point<std::chrono::steady_clock> newExpiryTime) noexcept
+    {
+        expiryTime = newExpiryTime;
+    }
+
+    inline std::chrono::time_point<std::chrono::steady_clock> getExpiryTime() const noexcept
+    {
+        return expiryTime;
+    }
+private:
+    std::pmr::memory_resource* memoryResource;
+    std::chrono::time_point<std::chrono::steady_clock> sendTime {};
+    std::chrono::time_point<std::chrono::steady_clock> deadline { std::chrono::time_point<std::chrono::steady_clock>::max() };
+    std::chrono::time_point<std::chrono::steady_clock> expiryTime { std::chrono::time_point<std::chrono::steady_clock>::max() };
+    bool isSheddable { false };
+    InlineCallable<InlineSize> callableObject;
+
+    template<typename TCallable>
+    TaskNode(std::pmr::memory_resource* initMemoryResource, TCallable&& initCallableObject)
+        : memoryResource(initMemoryResource)
+        , callableObject(initMemoryResource, std::forward<TCallable>(initCallableObject))
+    {}
+};
+
+using TaskNodePtr = std::unique_ptr<TaskNode, TaskNode::Deleter>;
+
+} // namespace gusc::Threads
+
+#endif /* GUSC_TASKNODE_HPP */
@@ -0,0 +1,264 @@
+//
+//  TimingWheel.hpp
+//  Threads
+//
+//  Created by Gusts Kaksis on 16/10/2026.
+//  Copyright © 2026 Gusts Kaksis. All rights reserved.
+//
+
+#ifndef GUSC_TIMINGWHEEL_HPP
+#define GUSC_TIMINGWHEEL_HPP
+
+#include "Utilities.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace gusc::Threads
+{
+
+/// @brief Base class for nodes that can be linked into TimingWheel
+class TimingWheelNode
+{
+public:
+    /// @brief get the tick at which the node expires
+    inline std::uint64_t getTick() const noexcept
+    {
+        return tick;
+    }
+    /// @brief check if the node is linked in a timing wheel
+    inline bool getIsLinked() const noexcept
+    {
+        return slotIndex != NoSlot;
+    }
+private:
+    template<typename, std::size_t> friend class TimingWheel;
+    static constexpr std::size_t NoSlot { std::numeric_limits<std::size_t>::max() };
+    TimingWheelNode* prev { nullptr };
+    TimingWheelNode* next { nullptr };
+    std::size_t slotIndex { NoSlot };
+    std::uint64_t tick { 0 };
+};
+
+/// @brief Hierarchical timing wheel of intrusive nodes that expire at integer ticks
+/// Every level has 64 slots and each slot of a level spans a whole rotation of the level below it. A node is linked in the level of the
+/// highest 6-bit digit in which it's tick differs from the current tick (nodes past the top level wait in an overflow slot) and is moved
+/// down when the current tick reaches it's slot, so insert and erase are O(1) and each node is moved at most once per level. Occupied slots
+/// are tracked in a bit mask per level, so idle ticks are skipped without visiting the slots.
+/// @note nodes of the same tick expire in the order they were linked, the wheel does not own the nodes and it's not thread-safe
+template<typename TNode, std::size_t LevelCount = 6>
+class TimingWheel
+{
+public:
+    static constexpr std::size_t SlotBits { 6 };
+    static constexpr std::size_t SlotCount { std::size_t(1) << SlotBits };
+
+    static_assert(LevelCount * SlotBits < 64, "Timing wheel levels don't fit in a 64-bit tick");
+
+    TimingWheel() = default;
+    TimingWheel(const TimingWheel&) = delete;
+    TimingWheel& operator=(const TimingWheel&) = delete;
+    TimingWheel(TimingWheel&&) = delete;
+    TimingWheel& operator=(TimingWheel&&) = delete;
+
+    /// @brief get the last tick that has been processed
+    inline std::uint64_t getTick() const noexcept
+    {
+        return currentTick;
+    }
+
+    inline bool empty() const noexcept
+    {
+        return count == 0;
+    }
+
+    inline std::size_t size() const noexcept
+    {
+        return count;
+    }
+
+    /// @brief link a node that expires at given tick (a tick that has already been processed expires at the next one)
+    /// @return the tick the node expires at
+    inline std::uint64_t insert(TNode* node, std::uint64_t tick) noexcept
+    {
+        node->tick = std::max(tick, currentTick + 1);
+        place(node);
+        ++count;
+        return node->tick;
+    }
+
+    /// @brief unlink a node before it has expired
+    inline void erase(TNode* node) noexcept
+    {
+        unlink(node);
+        --count;
+    }
+
+    /// @brief get the next tick at which advance() has work to do - the tick of the earliest node, or an earlier one at which nodes are
+    /// moved down from a higher level (std::numeric_limits<std::uint64_t>::max() if the wheel is empty)
+    inline std::uint64_t getNextTick() const noexcept
+    {
+        std::size_t level;
+        return findNextTick(level);
+    }
+
+    /// @brief process all the ticks up to and including given tick
+    /// @param callback - callable object with signature void(TNode*) that's called with every node that expires (already unlinked)
+    template<typename TCallback>
+    inline void advance(std::uint64_t tick, TCallback&& callback)
+    {
+        std::size_t level;
+        for (auto next = findNextTick(level); next <= tick; next = findNextTick(level))
+        {
+            currentTick = next;
+            auto node = detach(getSlotIndex(level, next));
+            while (node)
+            {
+                auto following = node->next;
+                if (node->tick <= currentTick)
+                {
+                    --count;
+                    callback(static_cast<TNode*>(node));
+                }
+                else
+                {
+                    // Slot of a higher level spans many ticks, it's nodes move down to the level of their next differing digit
+                    place(node);
+                }
+                node = following;
+            }
+        }
+        currentTick = std::max(currentTick, tick);
+    }
+
+    /// @brief unlink all the nodes
+    /// @param callback - callable object with signature void(TNode*) that's called with every node (already unlinked)
+    template<typename TCallback>
+    inline void clear(TCallback&& callback)
+    {
+        for (std::size_t index = 0; index < slots.size(); ++index)
+        {
+            auto node = detach(index);
+            while (node)
+            {
+                auto following = node->next;
+                --count;
+                callback(static_cast<TNode*>(node));
+                node = following;
+            }
+        }
+    }
+
+private:
+    struct Slot
+    {
+        TimingWheelNode* first { nullptr };
+        TimingWheelNode* last { nullptr };
+    };
+
+    /// @brief slots of all the levels one after another and the overflow slot at the end
+    std::array<Slot, LevelCount * SlotCount + 1> slots {};
+    /// @brief bit mask of non-empty slots per level
+    std::array<std::uint64_t, LevelCount> occupied {};
+    std::uint64_t currentTick { 0 };
+    std::size_t count { 0 };
+
+    static constexpr std::size_t OverflowSlot { LevelCount * SlotCount };
+
+    static inline std::size_t getSlotIndex(std::size_t level, std::uint64_t tick) noexcept
+    {
+        if (level == LevelCount)
+        {
+            return OverflowSlot;
+        }
+        return level * SlotCount + static_cast<std::size_t>((tick >> (level * SlotBits)) & (SlotCount - 1));
+    }
+
+    /// @brief find the earliest tick at which a slot has to be processed
+    /// @param level - set to the level of the slot (LevelCount for the overflow slot)
+    inline std::uint64_t findNextTick(std::size_t& level) const noexcept
+    {
+        for (level = 0; level < LevelCount; ++level)
+        {
+            // Nodes of a level share the higher digits with the current tick, so only the slots after the current one can be occupied
+            const auto shift = level * SlotBits;
+            const auto digit = (currentTick >> shift) & (SlotCount - 1);
+            const auto mask = occupied[level] & ((~std::uint64_t(0) << digit) << 1);
+            if (mask != 0)
+            {
+                const auto rotation = currentTick >> (shift + SlotBits) << (shift + SlotBits);
+                return rotation | (std::uint64_t(findFirstSet(mask)) << shift);
+            }
+        }
+        if (slots[OverflowSlot].first)
+        {
+            // Overflow nodes are looked at again once the top level has made a full rotation
+            constexpr auto shift = LevelCount * SlotBits;
+            return ((currentTick >> shift) + 1) << shift;
+        }
+        return std::numeric_limits<std::uint64_t>::max();
+    }
+
+    inline void place(TimingWheelNode* node) noexcept
+    {
+        const auto level = std::min<std::size_t>(findLastSet(node->tick ^ currentTick) / SlotBits, LevelCount);
+        const auto index = getSlotIndex(level, node->tick);
+        auto& slot = slots[index];
+        node->slotIndex = index;
+        node->prev = slot.last;
+        node->next = nullptr;
+        if (slot.last)
+        {
+            slot.last->next = node;
+        }
+        else
+        {
+            slot.first = node;
+            if (level < LevelCount)
+            {
+                occupied[level] |= std::uint64_t(1) << (index - level * SlotCount);
+            }
+        }
+        slot.last = node;
+    }
+
+    inline void unlink(TimingWheelNode* node) noexcept
+    {
+        const auto index = node->slotIndex;
+        auto& slot = slots[index];
+        (node->prev ? node->prev->next : slot.first) = node->next;
+        (node->next ? node->next->prev : slot.last) = node->prev;
+        if (!slot.first && index != OverflowSlot)
+        {
+            occupied[index / SlotCount] &= ~(std::uint64_t(1) << (index % SlotCount));
+        }
+        node->prev = nullptr;
+        node->next = nullptr;
+        node->slotIndex = TimingWheelNode::NoSlot;
+    }
+
+    /// @brief empty a slot
+    /// @return nodes of the slot still linked with each other, but no longer linked in the wheel
+    inline TimingWheelNode* detach(std::size_t index) noexcept
+    {
+        auto& slot = slots[index];
+        auto first = slot.first;
+        slot.first = nullptr;
+        slot.last = nullptr;
+        if (index != OverflowSlot)
+        {
+            occupied[index / SlotCount] &= ~(std::uint64_t(1) << (index % SlotCount));
+        }
+        for (auto node = first; node; node = node->next)
+        {
+            node->slotIndex = TimingWheelNode::NoSlot;
+        }
+        return first;
+    }
+};
+
+} // namespace gusc::Threads
+
+#endif /* GUSC_TIMINGWHEEL_HPP */
@@ -9,7 +9,13 @@
 #ifndef GUSC_UTILITIES_HPP
 #define GUSC_UTILITIES_HPP
 
+#include <cstdint>
 #include <mutex>
+#include <thread>
+
+#if defined(_MSC_VER)
+#   include <intrin.h>
+#endif
 
 namespace gusc
 {
@@ -22,7 +28,65 @@ using IsSameType = std::is_same<
         >::type
     >::type,
     TB
->;    
+>;
+
+/// @brief hint the CPU that we are in a spin-wait loop (lets the sibling hyper-thread run and saves power)
+inline void cpuRelax() noexcept
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_pause();
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+    __yield();
+#elif defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield" ::: "memory");
+#else
+    std::this_thread::yield();
+#endif
+}
+
+/// @brief get the index of the lowest set bit
+/// @note value must not be 0
+inline unsigned findFirstSet(std::uint64_t value) noexcept
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return static_cast<unsigned>(index);
+#elif defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_ctzll(value));
+#else
+    unsigned index { 0 };
+    while ((value & 1) == 0)
+    {
+        value >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+/// @brief get the index of the highest set bit
+/// @note value must not be 0
+inline unsigned findLastSet(std::uint64_t value) noexcept
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<unsigned>(index);
+#elif defined(__GNUC__) || defined(__clang__)
+    return 63 - static_cast<unsigned>(__builtin_clzll(value));
+#else
+    unsigned index { 0 };
+    while (value >>= 1)
+    {
+        ++index;
+    }
+    return index;
+#endif
+}
+
 } // namespace gusc
 
 #endif /* GUSC_UTILITIES_HPP */